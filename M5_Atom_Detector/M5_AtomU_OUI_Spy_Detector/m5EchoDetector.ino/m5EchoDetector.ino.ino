@@ -114,20 +114,201 @@ void startScanningRainbow();
 #endif
 i2s_chan_handle_t tx_handle = NULL;
 
+// Audio Engine
+// The I2S channel runs continuously off its DMA ring. Each time the driver
+// finishes sending one DMA frame its on_sent event wakes AudioEngineTask,
+// which mixes exactly one replacement frame from a sine wavetable and hands
+// it over without waiting. Alerts are note sequences queued to the engine,
+// so callers never block and overlapping alerts each get their own voice.
+// Worst-case alert-to-sound latency is one frame of queue polling plus the
+// DMA ring: (AUDIO_DMA_DESCRIPTORS + 1) * 4 ms = 20 ms.
+#define AUDIO_SAMPLE_RATE 16000
+#define AUDIO_FRAME_SAMPLES 64        // 4 ms per DMA frame
+#define AUDIO_DMA_DESCRIPTORS 4
+#define AUDIO_VOICES 4
+#define AUDIO_REQUEST_QUEUE 8
+#define AUDIO_RAMP_SAMPLES 32         // 2 ms attack/release, avoids clicks
+#define AUDIO_VOICE_GAIN 8000         // Q15, same level as the old playTone
+#define WAVETABLE_BITS 8
+#define WAVETABLE_SIZE (1 << WAVETABLE_BITS)
+
+// Proximity tone: pitch and level follow the strongest matched device
+#define PROXIMITY_RSSI_MIN -95
+#define PROXIMITY_RSSI_MAX -40
+#define PROXIMITY_FREQ_MIN 300
+#define PROXIMITY_FREQ_MAX 1200
+#define PROXIMITY_GAIN_MAX 2500
+#define PROXIMITY_HOLD_MS 3000
+
+// frequency 0 is a rest; durationMs 0 ends the sequence
+struct AudioNote {
+  uint16_t frequency;
+  uint16_t durationMs;
+};
+
+static const AudioNote SEQ_ASCENDING[] = { { 1800, 80 }, { 0, 30 }, { 2200, 80 }, { 0, 30 }, { 2600, 120 }, { 0, 0 } };
+static const AudioNote SEQ_DETECTION[] = { { 2400, 100 }, { 0, 40 }, { 2800, 100 }, { 0, 40 }, { 3200, 120 }, { 0, 0 } };
+static const AudioNote SEQ_REDETECT[] = { { 2000, 100 }, { 0, 50 }, { 2400, 100 }, { 0, 0 } };
+static const AudioNote SEQ_READY[] = { { 1600, 80 }, { 0, 30 }, { 2000, 80 }, { 0, 30 }, { 2400, 100 }, { 0, 0 } };
+static const AudioNote SEQ_ERROR[] = { { 800, 200 }, { 0, 100 }, { 800, 200 }, { 0, 0 } };
+
+struct AudioRequest {
+  const AudioNote* sequence;  // NULL plays single
+  AudioNote single;
+};
+
+struct AudioVoice {
+  const AudioNote* note;      // current step, NULL when idle
+  AudioNote single[2];        // storage for one-shot tones
+  uint32_t phase;             // top WAVETABLE_BITS index the wavetable
+  uint32_t increment;
+  uint32_t noteSamples;
+  uint32_t samplesLeft;
+  uint32_t startedFrame;
+};
+
+int16_t sineTable[WAVETABLE_SIZE];
+AudioVoice voices[AUDIO_VOICES];
+QueueHandle_t audioRequests = NULL;
+TaskHandle_t AudioEngineTaskHandle = NULL;
+int16_t audioFrame[AUDIO_FRAME_SAMPLES];
+uint32_t audioFrameCount = 0;
+volatile uint32_t audioFramesShort = 0;
+volatile uint32_t audioRequestsDropped = 0;
+
+// Written by ScanTask, read once per frame by AudioEngineTask. The tone
+// is off unless enabled in the config portal
+bool proximityToneEnabled = false;
+volatile uint32_t proximityIncrement = 0;
+volatile uint16_t proximityTargetGain = 0;
+uint32_t proximityPhase = 0;
+uint16_t proximityGain = 0;
+
+uint32_t phaseIncrement(uint16_t frequency) {
+  return (uint32_t)(((uint64_t)frequency << 32) / AUDIO_SAMPLE_RATE);
+}
+
+void startNote(AudioVoice& voice) {
+  if (voice.note->durationMs == 0) {
+    voice.note = NULL;
+    return;
+  }
+  voice.increment = phaseIncrement(voice.note->frequency);
+  voice.noteSamples = (uint32_t)voice.note->durationMs * (AUDIO_SAMPLE_RATE / 1000);
+  voice.samplesLeft = voice.noteSamples;
+}
+
+void startVoice(const AudioRequest& request) {
+  // Free voice if there is one, else the one that has played longest
+  AudioVoice* voice = &voices[0];
+  for (int i = 0; i < AUDIO_VOICES; i++) {
+    if (voices[i].note == NULL) {
+      voice = &voices[i];
+      break;
+    }
+    if (voices[i].startedFrame < voice->startedFrame) voice = &voices[i];
+  }
+
+  if (request.sequence) {
+    voice->note = request.sequence;
+  } else {
+    voice->single[0] = request.single;
+    voice->single[1].frequency = 0;
+    voice->single[1].durationMs = 0;
+    voice->note = voice->single;
+  }
+  voice->phase = 0;
+  voice->startedFrame = audioFrameCount;
+  startNote(*voice);
+}
+
+void mixFrame() {
+  AudioRequest request;
+  while (xQueueReceive(audioRequests, &request, 0) == pdTRUE) {
+    startVoice(request);
+  }
+
+  int32_t mix[AUDIO_FRAME_SAMPLES] = { 0 };
+
+  for (int v = 0; v < AUDIO_VOICES; v++) {
+    AudioVoice& voice = voices[v];
+    int i = 0;
+    while (voice.note != NULL && i < AUDIO_FRAME_SAMPLES) {
+      if (voice.samplesLeft == 0) {
+        voice.note++;
+        startNote(voice);
+        continue;
+      }
+      bool rest = voice.note->frequency == 0;
+      for (; i < AUDIO_FRAME_SAMPLES && voice.samplesLeft > 0; i++) {
+        if (!rest) {
+          uint32_t played = voice.noteSamples - voice.samplesLeft;
+          uint32_t ramp = played < voice.samplesLeft ? played : voice.samplesLeft;
+          int32_t gain = ramp < AUDIO_RAMP_SAMPLES ? AUDIO_VOICE_GAIN * (int32_t)ramp / AUDIO_RAMP_SAMPLES : AUDIO_VOICE_GAIN;
+          mix[i] += (sineTable[voice.phase >> (32 - WAVETABLE_BITS)] * gain) >> 15;
+          voice.phase += voice.increment;
+        }
+        voice.samplesLeft--;
+      }
+    }
+  }
+
+  // Proximity voice glides to its new level across the frame
+  uint16_t targetGain = proximityToneEnabled ? proximityTargetGain : 0;
+  if (proximityGain > 0 || targetGain > 0) {
+    uint32_t increment = proximityIncrement;
+    int32_t startGain = proximityGain;
+    int32_t delta = (int32_t)targetGain - startGain;
+    for (int i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+      int32_t gain = startGain + delta * i / AUDIO_FRAME_SAMPLES;
+      mix[i] += (sineTable[proximityPhase >> (32 - WAVETABLE_BITS)] * gain) >> 15;
+      proximityPhase += increment;
+    }
+    proximityGain = targetGain;
+  }
+
+  for (int i = 0; i < AUDIO_FRAME_SAMPLES; i++) {
+    int32_t s = audioEnabled ? mix[i] : 0;
+    if (s > 32767) s = 32767;
+    if (s < -32768) s = -32768;
+    audioFrame[i] = (int16_t)s;
+  }
+  audioFrameCount++;
+}
+
+static bool IRAM_ATTR i2sOnSent(i2s_chan_handle_t handle, i2s_event_data_t* event, void* userCtx) {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(AudioEngineTaskHandle, &woken);
+  return woken == pdTRUE;
+}
+
+// One notification per DMA frame sent; mix and write that many frames.
+// The write never waits: the frame that was just sent is the free slot.
+void AudioEngineTask(void* pvParameters) {
+  while (1) {
+    uint32_t framesDue = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while (framesDue-- > 0) {
+      mixFrame();
+      size_t bytes_written = 0;
+      i2s_channel_write(tx_handle, audioFrame, sizeof(audioFrame), &bytes_written, 0);
+      if (bytes_written < sizeof(audioFrame)) audioFramesShort++;
+    }
+  }
+}
 
 // I2S Speaker Functions
 void initI2SSpeaker() {
   i2s_chan_config_t chan_cfg = {
     .id = I2S_NUM_0,
     .role = I2S_ROLE_MASTER,
-    .dma_desc_num = 8,
-    .dma_frame_num = 64,
+    .dma_desc_num = AUDIO_DMA_DESCRIPTORS,
+    .dma_frame_num = AUDIO_FRAME_SAMPLES,
     .auto_clear = true,
   };
   
   i2s_std_config_t std_cfg = {
     .clk_cfg = {
-      .sample_rate_hz = 16000,
+      .sample_rate_hz = AUDIO_SAMPLE_RATE,
       .clk_src = I2S_CLK_SRC_DEFAULT,
       .mclk_multiple = I2S_MCLK_MULTIPLE_256,
     },
@@ -146,64 +327,89 @@ void initI2SSpeaker() {
     },
   };
   
+  for (int i = 0; i < WAVETABLE_SIZE; i++) {
+    sineTable[i] = (int16_t)(sin(2.0 * PI * i / WAVETABLE_SIZE) * 32767);
+  }
+  memset(voices, 0, sizeof(voices));
+  audioRequests = xQueueCreate(AUDIO_REQUEST_QUEUE, sizeof(AudioRequest));
+  
+  xTaskCreatePinnedToCore(
+    AudioEngineTask,
+    "AudioEngineTask",
+    3072,
+    NULL,
+    5,
+    &AudioEngineTaskHandle,
+    1
+  );
+  
   i2s_new_channel(&chan_cfg, &tx_handle, NULL);
   i2s_channel_init_std_mode(tx_handle, &std_cfg);
-  i2s_channel_enable(tx_handle);
-}
-
-void playTone(int frequency, int duration) {
-  if (!audioEnabled || tx_handle == NULL) return;
   
-  const int sampleRate = 16000;
-  const int samples = (sampleRate * duration) / 1000;
-  int16_t sample;
-  size_t bytes_written;
+  i2s_event_callbacks_t cbs = {
+    .on_recv = NULL,
+    .on_recv_q_ovf = NULL,
+    .on_sent = i2sOnSent,
+    .on_send_q_ovf = NULL,
+  };
+  i2s_channel_register_event_callback(tx_handle, &cbs, NULL);
   
-  for (int i = 0; i < samples; i++) {
-    sample = (int16_t)(sin(2.0 * PI * frequency * i / sampleRate) * 8000);
-    i2s_channel_write(tx_handle, &sample, sizeof(sample), &bytes_written, portMAX_DELAY);
+  // Fill the DMA ring with silence so on_sent paces the engine from the start
+  memset(audioFrame, 0, sizeof(audioFrame));
+  size_t loaded = sizeof(audioFrame);
+  while (loaded == sizeof(audioFrame)) {
+    i2s_channel_preload_data(tx_handle, audioFrame, sizeof(audioFrame), &loaded);
   }
   
-  sample = 0;
-  for (int i = 0; i < 500; i++) {
-    i2s_channel_write(tx_handle, &sample, sizeof(sample), &bytes_written, portMAX_DELAY);
+  i2s_channel_enable(tx_handle);
+}
+
+void queueAudio(const AudioRequest& request) {
+  if (!audioEnabled || audioRequests == NULL) return;
+  if (xQueueSend(audioRequests, &request, 0) != pdTRUE) audioRequestsDropped++;
+}
+
+void playSequence(const AudioNote* sequence) {
+  AudioRequest request = { sequence, { 0, 0 } };
+  queueAudio(request);
+}
+
+void playTone(int frequency, int duration) {
+  AudioRequest request = { NULL, { (uint16_t)frequency, (uint16_t)duration } };
+  queueAudio(request);
+}
+
+// rssi 0 (or anything below PROXIMITY_RSSI_MIN) silences the proximity tone
+void setProximityTone(int rssi) {
+  if (rssi == 0 || rssi < PROXIMITY_RSSI_MIN) {
+    proximityTargetGain = 0;
+    return;
   }
+  if (rssi > PROXIMITY_RSSI_MAX) rssi = PROXIMITY_RSSI_MAX;
+  int span = PROXIMITY_RSSI_MAX - PROXIMITY_RSSI_MIN;
+  int level = rssi - PROXIMITY_RSSI_MIN;
+  proximityIncrement = phaseIncrement(PROXIMITY_FREQ_MIN + (PROXIMITY_FREQ_MAX - PROXIMITY_FREQ_MIN) * level / span);
+  proximityTargetGain = PROXIMITY_GAIN_MAX * level / span;
 }
 
 void playAscendingTones() {
-  playTone(1800, 80);
-  delay(30);
-  playTone(2200, 80);
-  delay(30);
-  playTone(2600, 120);
+  playSequence(SEQ_ASCENDING);
 }
 
 void playDetectionAlert() {
-  playTone(2400, 100);
-  delay(40);
-  playTone(2800, 100);
-  delay(40);
-  playTone(3200, 120);
+  playSequence(SEQ_DETECTION);
 }
 
 void playRedetectAlert() {
-  playTone(2000, 100);
-  delay(50);
-  playTone(2400, 100);
+  playSequence(SEQ_REDETECT);
 }
 
 void playReadyChime() {
-  playTone(1600, 80);
-  delay(30);
-  playTone(2000, 80);
-  delay(30);
-  playTone(2400, 100);
+  playSequence(SEQ_READY);
 }
 
 void playErrorTone() {
-  playTone(800, 200);
-  delay(100);
-  playTone(800, 200);
+  playSequence(SEQ_ERROR);
 }
 
 // RGB Color Utilities
@@ -494,6 +700,14 @@ void ScanTask(void* pvParameters) {
           
           pBLEScan->start(0.8, false);
         }
+        
+        int strongestRssi = 0;
+        for (auto& dev : devices) {
+          if (currentMillis - dev.lastSeen < PROXIMITY_HOLD_MS && (strongestRssi == 0 || dev.rssi > strongestRssi)) {
+            strongestRssi = dev.rssi;
+          }
+        }
+        setProximityTone(strongestRssi);
         lastScanTime = currentMillis;
       }
 
@@ -504,6 +718,7 @@ void ScanTask(void* pvParameters) {
 
       if (currentMillis - lastStatusTime >= 30000) {
         Serial.println("Status: Scanning - " + String(devices.size()) + " active devices tracked");
+        Serial.println("Audio: " + String(audioFramesShort) + " short frames, " + String(audioRequestsDropped) + " alerts dropped");
         lastStatusTime = currentMillis;
       }
     }
@@ -706,6 +921,7 @@ void saveConfiguration() {
   preferences.begin("ouispy", false);
   preferences.putInt("filterCount", targetFilters.size());
   preferences.putBool("audioEnabled", audioEnabled);
+  preferences.putBool("proximityTone", proximityToneEnabled);
 
   for (int i = 0; i < targetFilters.size(); i++) {
     String keyId = "id_" + String(i);
@@ -725,6 +941,7 @@ void loadConfiguration() {
   preferences.begin("ouispy", true);
   int filterCount = preferences.getInt("filterCount", 0);
   audioEnabled = preferences.getBool("audioEnabled", true);
+  proximityToneEnabled = preferences.getBool("proximityTone", false);
 
   targetFilters.clear();
 
@@ -821,12 +1038,17 @@ String generateConfigHTML() {
                 <h3>MAC Addresses</h3>
                 <textarea name="macs"></textarea>
             </div>
+            <div class="section">
+                <h3>Audio</h3>
+                <label><input type="checkbox" name="proximityTone" value="1" %PROXIMITY_TONE%> Proximity tone - a steady hum that rises in pitch as the nearest matched device gets closer</label>
+            </div>
             <button type="submit">Save & Start Scanning</button>
         </form>
     </div>
 </body>
 </html>
 )html";
+  html.replace("%PROXIMITY_TONE%", proximityToneEnabled ? "checked" : "");
   return html;
 }
 
@@ -870,6 +1092,7 @@ void startConfigMode() {
     lastConfigActivity = millis();
     
     targetFilters.clear();
+    proximityToneEnabled = request->hasParam("proximityTone", true);
     
     Serial.println("=== Form Data Received ===");
     
@@ -1044,10 +1267,10 @@ void setup() {
   
   initI2SSpeaker();
   
+  // Boot chirp is queued to the audio engine; the pixel stays lit until
+  // AudioLEDTask takes the LED over
   M5.dis.drawpix(0, 0x008000FF);
   playTone(2000, 200);
-  delay(300);
-  M5.dis.clear();
   
   Serial.println("\n\n=== ATOM ECHO OUI-SPY ===");
   Serial.println("Mode: BLE/WiFi device detection with RGB + Audio");
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ================================
+// Zero-Copy Advertisement Parser
+// ================================
+// Walks the AD structures of a raw BLE advert (length, type, value...)
+// and hands out views into the caller's buffer. Nothing is copied or
+// allocated, so it is safe at full advert rate inside the scan callback.
+// No Arduino/NimBLE dependencies - builds on the host as-is.
+
+// AD types (Bluetooth Core Specification Supplement, Part A, 1)
+#define AD_TYPE_FLAGS               0x01
+#define AD_TYPE_UUID16_INCOMPLETE   0x02
+#define AD_TYPE_UUID16_COMPLETE     0x03
+#define AD_TYPE_UUID128_INCOMPLETE  0x06
+#define AD_TYPE_UUID128_COMPLETE    0x07
+#define AD_TYPE_NAME_SHORT          0x08
+#define AD_TYPE_NAME_COMPLETE       0x09
+#define AD_TYPE_TX_POWER            0x0A
+#define AD_TYPE_SERVICE_DATA16      0x16
+#define AD_TYPE_SERVICE_DATA128     0x21
+#define AD_TYPE_MANUFACTURER_DATA   0xFF
+
+inline uint16_t readLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint64_t readLE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// Non-owning view of bytes inside the advert buffer
+struct AdSpan {
+    const uint8_t* data;
+    uint8_t length;
+
+    AdSpan() : data(nullptr), length(0) {}
+    AdSpan(const uint8_t* d, uint8_t len) : data(d), length(len) {}
+
+    bool empty() const { return length == 0; }
+    AdSpan subspan(uint8_t offset) const {
+        return offset >= length ? AdSpan() : AdSpan(data + offset, length - offset);
+    }
+};
+
+struct AdField {
+    uint8_t type;
+    AdSpan value;  // payload of the AD structure, type byte excluded
+};
+
+// Iterates AD structures in order. Stops at the end of the buffer, at a
+// zero-length structure (significant part padding), or at a structure
+// that runs past the buffer - including a lone length byte at the very
+// end - which is reported by malformed().
+class AdIterator {
+public:
+    AdIterator(const uint8_t* payload, size_t length)
+        : payload_(payload), length_(length), pos_(0), malformed_(false) {}
+
+    bool next(AdField& field) {
+        if (payload_ == nullptr || pos_ >= length_) return false;
+
+        uint8_t fieldLength = payload_[pos_];
+        if (fieldLength == 0) return false;
+        if (pos_ + 1 + fieldLength > length_) {
+            malformed_ = true;
+            return false;
+        }
+
+        field.type = payload_[pos_ + 1];
+        field.value = AdSpan(payload_ + pos_ + 2, fieldLength - 1);
+        pos_ += 1 + fieldLength;
+        return true;
+    }
+
+    bool malformed() const { return malformed_; }
+
+private:
+    const uint8_t* payload_;
+    size_t length_;
+    size_t pos_;
+    bool malformed_;
+};
+
+// One-pass summary of the commonly used fields. For fields that may repeat
+// (service data, UUID lists) the first occurrence is kept; use AdIterator
+// directly to see every one.
+struct AdSummary {
+    bool hasFlags;
+    uint8_t flags;
+    bool hasTxPower;
+    int8_t txPower;           // dBm
+    AdSpan name;              // local name bytes, not NUL-terminated
+    bool nameComplete;
+    AdSpan manufacturerData;  // starts with the 16-bit company ID
+    AdSpan serviceData16;     // starts with the 16-bit service UUID
+    AdSpan serviceData128;    // starts with the 128-bit service UUID
+    AdSpan uuid16List;        // packed little-endian 16-bit UUIDs
+    AdSpan uuid128List;       // packed little-endian 128-bit UUIDs
+    bool malformed;
+
+    AdSummary()
+        : hasFlags(false), flags(0), hasTxPower(false), txPower(0), nameComplete(false),
+          malformed(false) {}
+
+    bool hasCompanyId() const { return manufacturerData.length >= 2; }
+    uint16_t companyId() const { return readLE16(manufacturerData.data); }
+
+    static AdSummary parse(const uint8_t* payload, size_t length) {
+        AdSummary summary;
+        AdIterator it(payload, length);
+        AdField field;
+
+        while (it.next(field)) {
+            switch (field.type) {
+                case AD_TYPE_FLAGS:
+                    if (field.value.length >= 1) {
+                        summary.hasFlags = true;
+                        summary.flags = field.value.data[0];
+                    }
+                    break;
+                case AD_TYPE_TX_POWER:
+                    if (field.value.length >= 1) {
+                        summary.hasTxPower = true;
+                        summary.txPower = (int8_t)field.value.data[0];
+                    }
+                    break;
+                case AD_TYPE_NAME_COMPLETE:
+                    // A complete name beats a shortened one wherever it appears
+                    summary.name = field.value;
+                    summary.nameComplete = true;
+                    break;
+                case AD_TYPE_NAME_SHORT:
+                    if (!summary.nameComplete && summary.name.empty()) summary.name = field.value;
+                    break;
+                case AD_TYPE_MANUFACTURER_DATA:
+                    if (summary.manufacturerData.empty()) summary.manufacturerData = field.value;
+                    break;
+                case AD_TYPE_SERVICE_DATA16:
+                    if (summary.serviceData16.empty()) summary.serviceData16 = field.value;
+                    break;
+                case AD_TYPE_SERVICE_DATA128:
+                    if (summary.serviceData128.empty()) summary.serviceData128 = field.value;
+                    break;
+                case AD_TYPE_UUID16_INCOMPLETE:
+                case AD_TYPE_UUID16_COMPLETE:
+                    if (summary.uuid16List.empty()) summary.uuid16List = field.value;
+                    break;
+                case AD_TYPE_UUID128_INCOMPLETE:
+                case AD_TYPE_UUID128_COMPLETE:
+                    if (summary.uuid128List.empty()) summary.uuid128List = field.value;
+                    break;
+            }
+        }
+
+        summary.malformed = it.malformed();
+        return summary;
+    }
+};
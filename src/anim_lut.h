@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ================================
+// Animation Lookup Tables
+// ================================
+// Sine and hue tables for the NeoPixel animations, computed by the
+// compiler so no floating point runs per pixel at frame time.
+// No Arduino dependencies - builds on the host as-is.
+
+// C++11 has no std::index_sequence
+template <size_t... I> struct IndexSequence {};
+template <size_t N, size_t... I> struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+template <size_t... I> struct MakeIndexSequence<0, I...> { typedef IndexSequence<I...> type; };
+
+// ---- Sine ----
+// SINE_LUT[i] = (sin(2*pi*i/256) * 0.5 + 0.5) * 255: a full period in
+// 256 phase steps, 0-255 output (Q8, 255 ~ 1.0)
+
+constexpr double LUT_PI = 3.14159265358979323846;
+
+// Taylor series, accurate to well under 1/255 on [-pi/2, pi/2]
+constexpr double lutSinTaylor(double x) {
+    return x * (1 - x * x / 6 * (1 - x * x / 20 * (1 - x * x / 42 * (1 - x * x / 72))));
+}
+
+// x in [-pi, pi]
+constexpr double lutSin(double x) {
+    return x > LUT_PI / 2 ? lutSinTaylor(LUT_PI - x)
+         : x < -LUT_PI / 2 ? lutSinTaylor(-LUT_PI - x)
+         : lutSinTaylor(x);
+}
+
+constexpr uint8_t sineEntry(size_t i) {
+    return (uint8_t)(lutSin(2 * LUT_PI * (i < 128 ? (double)i : (double)i - 256) / 256) * 127.5 + 128.0);
+}
+
+template <typename Seq> struct SineTable;
+template <size_t... I> struct SineTable<IndexSequence<I...> > {
+    static constexpr uint8_t values[sizeof...(I)] = {sineEntry(I)...};
+};
+template <size_t... I> constexpr uint8_t SineTable<IndexSequence<I...> >::values[sizeof...(I)];
+
+typedef SineTable<MakeIndexSequence<256>::type> SineLUT;
+
+static_assert(SineLUT::values[0] == 128 && SineLUT::values[64] == 255 && SineLUT::values[192] == 0,
+              "sine table out of range");
+
+inline uint8_t sine8(uint8_t phase) {
+    return SineLUT::values[phase];
+}
+
+// ---- Hue ----
+// Fully saturated, full brightness colour (0xRRGGBB) for each hue, using
+// the same six-region integer conversion as hsvToRgb() - including its
+// hue scale, where 43 steps make one region and hues past 255 fall into
+// the last region. Covers every hue the animations produce.
+#define HUE_LUT_SIZE 384
+
+constexpr uint8_t hueRegion(uint16_t h) { return (uint8_t)(h / 43); }
+constexpr uint8_t hueRemainder(uint16_t h) { return (uint8_t)((h - hueRegion(h) * 43) * 6); }
+constexpr uint8_t hueQ(uint16_t h) { return (uint8_t)((255 * (255 - ((255 * hueRemainder(h)) >> 8))) >> 8); }
+constexpr uint8_t hueT(uint16_t h) { return (uint8_t)((255 * (255 - ((255 * (255 - hueRemainder(h))) >> 8))) >> 8); }
+
+constexpr uint32_t packRGB(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+constexpr uint32_t hueEntry(uint16_t h) {
+    return hueRegion(h) == 0 ? packRGB(255, hueT(h), 0)
+         : hueRegion(h) == 1 ? packRGB(hueQ(h), 255, 0)
+         : hueRegion(h) == 2 ? packRGB(0, 255, hueT(h))
+         : hueRegion(h) == 3 ? packRGB(0, hueQ(h), 255)
+         : hueRegion(h) == 4 ? packRGB(hueT(h), 0, 255)
+         : packRGB(255, 0, hueQ(h));
+}
+
+template <typename Seq> struct HueTable;
+template <size_t... I> struct HueTable<IndexSequence<I...> > {
+    static constexpr uint32_t values[sizeof...(I)] = {hueEntry(I)...};
+};
+template <size_t... I> constexpr uint32_t HueTable<IndexSequence<I...> >::values[sizeof...(I)];
+
+typedef HueTable<MakeIndexSequence<HUE_LUT_SIZE>::type> HueLUT;
+
+// Scales one 0-255 channel by a 0-255 level, Q8
+inline uint8_t scale8(uint8_t value, uint8_t level) {
+    return (uint8_t)(((uint16_t)value * (level + 1)) >> 8);
+}
+
+// hsvToRgb(hue, 255, value) without the per-call arithmetic
+inline uint32_t hueColor(uint16_t hue, uint8_t value) {
+    uint32_t c = HueLUT::values[hue < HUE_LUT_SIZE ? hue : HUE_LUT_SIZE - 1];
+    return packRGB(scale8((uint8_t)(c >> 16), value), scale8((uint8_t)(c >> 8), value), scale8((uint8_t)c, value));
+}
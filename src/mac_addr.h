@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ================================
+// Packed 48-bit MAC Address
+// ================================
+// Stored most significant octet first, so aa:bb:cc:dd:ee:ff == 0xaabbccddeeff
+// and the OUI is simply the top 24 bits. No heap, no text until output.
+struct MacAddr {
+    uint64_t value;
+
+    constexpr MacAddr() : value(0) {}
+    constexpr explicit MacAddr(uint64_t v) : value(v & 0xFFFFFFFFFFFFULL) {}
+
+    // Octets in display order (b[0] is the first octet printed)
+    static MacAddr fromBytes(const uint8_t* b) {
+        uint64_t v = 0;
+        for (int i = 0; i < 6; i++) {
+            v = (v << 8) | b[i];
+        }
+        return MacAddr(v);
+    }
+
+    // Octets in little-endian radio order (NimBLEAddress::getNative())
+    static MacAddr fromLittleEndian(const uint8_t* b) {
+        uint64_t v = 0;
+        for (int i = 5; i >= 0; i--) {
+            v = (v << 8) | b[i];
+        }
+        return MacAddr(v);
+    }
+
+    constexpr uint32_t oui() const { return (uint32_t)(value >> 24); }
+    constexpr uint8_t octet(int i) const { return (uint8_t)(value >> (40 - 8 * i)); }
+
+    // Mask keeping the top `bits` of the 48-bit address
+    static constexpr uint64_t prefixMask(int bits) {
+        return bits <= 0 ? 0 : (0xFFFFFFFFFFFFULL << (48 - (bits > 48 ? 48 : bits))) & 0xFFFFFFFFFFFFULL;
+    }
+    constexpr MacAddr masked(int bits) const { return MacAddr(value & prefixMask(bits)); }
+
+    constexpr bool operator==(const MacAddr& o) const { return value == o.value; }
+    constexpr bool operator!=(const MacAddr& o) const { return value != o.value; }
+    constexpr bool operator<(const MacAddr& o) const { return value < o.value; }
+
+    // Writes "aa:bb:cc" (octets = 3) or "aa:bb:cc:dd:ee:ff" (octets = 6).
+    // out must hold at least 3 * octets bytes.
+    void format(char* out, int octets = 6) const {
+        static const char hex[] = "0123456789abcdef";
+        for (int i = 0; i < octets; i++) {
+            uint8_t b = octet(i);
+            *out++ = hex[b >> 4];
+            *out++ = hex[b & 0x0F];
+            *out++ = (i < octets - 1) ? ':' : '\0';
+        }
+    }
+
+    // Parses "aa:bb:cc" or "aa:bb:cc:dd:ee:ff" (case-insensitive, '-' accepted
+    // as separator, spaces ignored). Missing octets are zero-filled so an OUI
+    // lands in the top 24 bits. Returns the number of octets parsed (3 or 6),
+    // or 0 if the text is not a valid OUI/MAC.
+    static int parse(const char* text, MacAddr& out) {
+        uint64_t v = 0;
+        int octets = 0;
+        int digits = 0;  // hex digits in the current octet
+
+        for (const char* p = text; *p; p++) {
+            char c = *p;
+            if (c == ' ') continue;
+            if (c == ':' || c == '-') {
+                if (digits != 2) return 0;
+                digits = 0;
+                continue;
+            }
+            int nibble = hexValue(c);
+            if (nibble < 0) return 0;
+            if (digits == 0) {
+                if (octets == 6) return 0;
+                octets++;
+            } else if (digits == 2) {
+                return 0;  // octets must be separated
+            }
+            v = (v << 4) | (uint64_t)nibble;
+            digits++;
+        }
+
+        if (digits != 2 || (octets != 3 && octets != 6)) return 0;
+        // v holds 2 * octets nibbles; left-align into 48 bits
+        out = MacAddr(v << (8 * (6 - octets)));
+        return octets;
+    }
+
+    // Parses a prefix of any bit length: hex digits with optional ':', '-',
+    // '.' or ' ' separators, optionally followed by "/bits". Without an
+    // explicit length each hex digit counts 4 bits, so "aa:bb:cc:d" is a
+    // 28-bit MA-M block and "aa:bb:cc:dd:e" a 36-bit MA-S block. Bits past
+    // the prefix length are cleared. An explicit length may not exceed the
+    // digits given. Returns the length (1-48), or 0.
+    static int parsePrefix(const char* text, MacAddr& out) {
+        uint64_t v = 0;
+        int digits = 0;
+        const char* p = text;
+
+        for (; *p && *p != '/'; p++) {
+            char c = *p;
+            if (c == ':' || c == '-' || c == '.' || c == ' ') continue;
+            int nibble = hexValue(c);
+            if (nibble < 0 || digits == 12) return 0;
+            v = (v << 4) | (uint64_t)nibble;
+            digits++;
+        }
+        if (digits == 0) return 0;
+
+        int bits = digits * 4;
+        if (*p == '/') {
+            bits = 0;
+            int lengthDigits = 0;
+            for (p++; *p; p++) {
+                if (*p == ' ') continue;
+                if (*p < '0' || *p > '9') return 0;
+                bits = bits * 10 + (*p - '0');
+                if (bits > 48) return 0;
+                lengthDigits++;
+            }
+            // The digits given must cover the length: "aa/40" is rejected
+            if (lengthDigits == 0 || bits == 0 || bits > digits * 4) return 0;
+        }
+
+        out = MacAddr(v << (4 * (12 - digits))).masked(bits);
+        return bits;
+    }
+
+    // Shortest text that round-trips through parsePrefix: nibble-aligned
+    // lengths as plain hex ("aa:bb:cc", "aa:bb:cc:d"), others with an
+    // explicit length ("aa:bb:cc:dc/30"). out must hold at least 21 bytes.
+    void formatPrefix(char* out, int bits) const {
+        static const char hex[] = "0123456789abcdef";
+        int digits = (bits + 3) / 4;
+        for (int i = 0; i < digits; i++) {
+            if (i > 0 && i % 2 == 0) *out++ = ':';
+            *out++ = hex[(value >> (44 - 4 * i)) & 0x0F];
+        }
+        if (bits % 4 != 0) {
+            *out++ = '/';
+            if (bits >= 10) *out++ = (char)('0' + bits / 10);
+            *out++ = (char)('0' + bits % 10);
+        }
+        *out = '\0';
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+};
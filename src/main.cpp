@@ -3,6 +3,7 @@
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include <Preferences.h>
+#include <LittleFS.h>
 #include <NimBLEDevice.h>
 #include <NimBLEUtils.h>
 #include <NimBLEScan.h>
@@ -10,18 +11,30 @@
 #include <esp_log.h>
 #include <esp_wifi.h>
 #include <nvs_flash.h>
+#include <mbedtls/aes.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <vector>
+#include <map>
 #include <algorithm>
-#include <Adafruit_NeoPixel.h>
+#include <new>
+#include <memory>
+#include <driver/rmt.h>
+#include "mac_addr.h"
+#include "oui_db.h"
+#include "ad_parser.h"
+#include "spsc_ring.h"
+#include "anim_lut.h"
+#include "nvs_blob.h"
 
 // ================================
 // Pin and Buzzer Definitions - Xiao ESP32 S3
 // ================================
 #define BUZZER_PIN 3   // GPIO3 (D2) for buzzer - good PWM pin on Xiao ESP32 S3
 #define BUZZER_FREQ 1600  // Frequency in Hz
-#define BUZZER_DUTY 100  // 50% duty cycle for good volume without excessive power draw
 #define BEEP_DURATION 200  // Duration of each beep in ms
 #define BEEP_PAUSE 150  // Pause between beeps in ms
+#define BEEP_TAIL_FREQ 2000  // Second half of each beep, formerly bit-banged
 #define LED_PIN 21   // GPIO21 for onboard LED (inverted logic)
 
 // ================================
@@ -31,12 +44,11 @@
 #define NEOPIXEL_COUNT 8 // Number of NeoPixels (1 for single pixel)
 #define NEOPIXEL_BRIGHTNESS 50 // Brightness (0-255)
 #define NEOPIXEL_DETECTION_BRIGHTNESS 200 // Brightness during detection (0-255)
+#define ANIMATION_FRAME_MS 30 // Fixed frame period (~33 fps)
+#define NEOPIXEL_RMT_CHANNEL RMT_CHANNEL_0
 int averageRSSI = -100;
 unsigned long lastRSSIUpdate = 0;
 
-// NeoPixel object
-Adafruit_NeoPixel strip(NEOPIXEL_COUNT, NEOPIXEL_PIN, NEO_GRB + NEO_KHZ800);
-
 // NeoPixel state variables
 bool detectionMode = false;
 unsigned long detectionStartTime = 0;
@@ -71,47 +83,128 @@ unsigned long modeSwitchScheduled = 0; // When to switch modes (0 = not schedule
 unsigned long deviceResetScheduled = 0; // When to reset device (0 = not scheduled)
 unsigned long normalRestartScheduled = 0; // When to do normal restart (0 = not scheduled)
 
-// Serial output synchronization - avoid concurrent writes
-volatile bool newMatchFound = false;
-String detectedMAC = "";
-int detectedRSSI = 0;
-String matchedFilter = "";
-String matchType = "";  // "NEW", "RE-5s", "RE-30s"
+// Detection events: published by the BLE callback, drained by loop()
+// for serial output, in order and without sharing Strings across tasks
+enum DetectionType : uint8_t {
+    DETECTION_NEW,
+    DETECTION_RE_5S,
+    DETECTION_RE_30S
+};
+
+const char* const DETECTION_TYPE_NAMES[] = {"NEW", "RE-5s", "RE-30s"};
+
+struct DetectionEvent {
+    uint32_t seq;          // gaps mean events were dropped
+    uint32_t timestamp;    // millis()
+    uint64_t mac;          // MacAddr::value
+    int8_t rssi;
+    int8_t rssiFiltered;   // dBm, per-device filter output
+    uint8_t trend;         // RSSITrend
+    uint8_t type;          // DetectionType
+    uint8_t description;   // index into deviceDescriptions
+};
+
+#define DETECTION_RING_SIZE 64
+#define DETECTION_DRAIN_BATCH 16
+
+SpscRing<DetectionEvent, DETECTION_RING_SIZE> detectionEvents;
+uint32_t detectionSeq = 0;  // BLE callback only
+
+// Tracked device table size, see Tracked Device Table. Both can be
+// overridden from build_flags. By default the index gets the next power
+// of two at or above 4/3 of the capacity, so it stays at most three
+// quarters full and probe chains stay short
+#ifndef DEVICE_TABLE_CAPACITY
+#ifdef BOARD_HAS_PSRAM
+#define DEVICE_TABLE_CAPACITY 8192
+#else
+#define DEVICE_TABLE_CAPACITY 1024
+#endif
+#endif
+
+#ifndef DEVICE_INDEX_SLOTS
+#define DEVICE_INDEX_MIN_SLOTS ((DEVICE_TABLE_CAPACITY * 4 + 2) / 3)
+#if DEVICE_INDEX_MIN_SLOTS <= 64
+#define DEVICE_INDEX_SLOTS 64
+#elif DEVICE_INDEX_MIN_SLOTS <= 128
+#define DEVICE_INDEX_SLOTS 128
+#elif DEVICE_INDEX_MIN_SLOTS <= 256
+#define DEVICE_INDEX_SLOTS 256
+#elif DEVICE_INDEX_MIN_SLOTS <= 512
+#define DEVICE_INDEX_SLOTS 512
+#elif DEVICE_INDEX_MIN_SLOTS <= 1024
+#define DEVICE_INDEX_SLOTS 1024
+#elif DEVICE_INDEX_MIN_SLOTS <= 2048
+#define DEVICE_INDEX_SLOTS 2048
+#elif DEVICE_INDEX_MIN_SLOTS <= 4096
+#define DEVICE_INDEX_SLOTS 4096
+#elif DEVICE_INDEX_MIN_SLOTS <= 8192
+#define DEVICE_INDEX_SLOTS 8192
+#elif DEVICE_INDEX_MIN_SLOTS <= 16384
+#define DEVICE_INDEX_SLOTS 16384
+#elif DEVICE_INDEX_MIN_SLOTS <= 32768
+#define DEVICE_INDEX_SLOTS 32768
+#elif DEVICE_INDEX_MIN_SLOTS <= 65536
+#define DEVICE_INDEX_SLOTS 65536
+#else
+#define DEVICE_INDEX_SLOTS 131072
+#endif
+#endif
 
 // Persistent settings
 bool buzzerEnabled = true;
 bool ledEnabled = true;
+uint32_t builtinVendorMask = 0;  // bit i enables OUI_DB_VENDORS[i] from ouis.md
+size_t deviceTableLimit = DEVICE_TABLE_CAPACITY;  // tracked devices, <= capacity
 
-// Device tracking
-struct DeviceInfo {
-    String macAddress;
-    int rssi;
-    unsigned long firstSeen;
-    unsigned long lastSeen;
-    bool inCooldown;
-    unsigned long cooldownUntil;
-    const char* matchedFilter;
-    String filterDescription;  // Store filter description for persistence
+enum FilterKind : uint8_t {
+    FILTER_MAC,           // MAC prefix of any length, incl. OUI and full MAC
+    FILTER_COMPANY_ID,    // Manufacturer-specific data company identifier
+    FILTER_UUID16,        // 16-bit service UUID (list or service data)
+    FILTER_UUID128,       // 128-bit service UUID (list or service data)
+    FILTER_NAME_PREFIX    // Shortened/complete local name prefix
 };
 
 struct TargetFilter {
-    String identifier;
-    bool isFullMAC;
+    FilterKind kind;
+    MacAddr identifier;  // FILTER_MAC: prefix left-aligned, bits past prefixBits cleared
+    uint8_t prefixBits;  // FILTER_MAC: 24 = OUI, 28 = MA-M, 36 = MA-S, 48 = full MAC
+    uint16_t payloadId;  // FILTER_COMPANY_ID / FILTER_UUID16
+    String pattern;      // FILTER_UUID128: canonical UUID text, FILTER_NAME_PREFIX: name prefix
     String description;
+    uint8_t descriptionId;  // description interned by rebuildFilterIndex()
+    
+    bool isMAC() const { return kind == FILTER_MAC; }
+    bool isFullMAC() const { return kind == FILTER_MAC && prefixBits == 48; }
+};
+
+// Identity Resolving Key of a device we own, used to follow it across
+// resolvable private address rotations
+struct IdentityKey {
+    uint8_t irk[16];     // most significant octet first, as displayed
+    MacAddr identity;    // stable address devices are tracked under
+    String name;
+    uint8_t descriptionId;  // "IRK: " + name, interned by resetRPACache()
 };
 
-struct DeviceAlias {
-    String macAddress;
-    String alias;
+// User-assigned device name. Entries are kept sorted by MAC for binary
+// search; names live NUL-terminated in one shared pool (aliasNames).
+struct AliasEntry {
+    uint64_t mac;         // MacAddr::value
+    uint32_t nameOffset;  // into aliasNames
 };
 
-std::vector<DeviceInfo> devices;
 std::vector<TargetFilter> targetFilters;
-std::vector<DeviceAlias> deviceAliases;
+std::vector<AliasEntry> deviceAliases;  // sorted by mac
+std::vector<char> aliasNames;
+size_t aliasNamesGarbage = 0;           // pool bytes no entry points at
+std::vector<IdentityKey> identityKeys;
 
 // Forward declarations
 void startScanningMode();
 void startDetectionFlash();
+void setDeviceTableLimit(size_t limit);
+void initializeTonePlayer();
 
 // ================================
 // Serial Configuration
@@ -152,49 +245,207 @@ void initializeBuzzer() {
     // Setup LED (inverted logic - HIGH = OFF for Xiao ESP32-S3)
     pinMode(LED_PIN, OUTPUT);
     digitalWrite(LED_PIN, HIGH);
+    
+    initializeTonePlayer();
 }
 
-void digitalBeep(int duration) {
-    unsigned long startTime = millis();
-    while (millis() - startTime < duration) {
-        digitalWrite(BUZZER_PIN, HIGH);
-        delayMicroseconds(250);
-        digitalWrite(BUZZER_PIN, LOW);
-        delayMicroseconds(250);
+// Tone patterns are tables of steps played by an esp_timer one-shot: each
+// callback sets the LEDC tone (or silence) and arms the timer for the next
+// step, so nothing waits on the CPU while a pattern plays. Any table can be
+// played, melodies included. A zero-duration step ends the pattern.
+struct ToneStep {
+    uint16_t frequency;   // Hz, 0 = silence (LED off)
+    uint16_t durationMs;
+};
+
+// Each beep is BEEP_DURATION at BUZZER_FREQ followed by BEEP_DURATION at
+// BEEP_TAIL_FREQ, with the LED lit throughout
+#define TONE_BEEP {BUZZER_FREQ, BEEP_DURATION}, {BEEP_TAIL_FREQ, BEEP_DURATION}
+#define TONE_PAUSE {0, BEEP_PAUSE}
+#define TONE_END {0, 0}
+
+const ToneStep PATTERN_SINGLE_BEEP[] = {TONE_BEEP, TONE_END};
+const ToneStep PATTERN_TWO_BEEPS[] = {TONE_BEEP, TONE_PAUSE, TONE_BEEP, TONE_END};
+const ToneStep PATTERN_THREE_BEEPS[] = {TONE_BEEP, TONE_PAUSE, TONE_BEEP, TONE_PAUSE, TONE_BEEP, TONE_END};
+// Two fast ascending beeps to indicate "ready to scan" - close melodic interval, not octave
+const ToneStep PATTERN_ASCENDING[] = {{1900, BEEP_DURATION}, {0, 100}, {2200, BEEP_DURATION}, TONE_END};
+
+esp_timer_handle_t toneTimer = nullptr;
+SemaphoreHandle_t toneDone = nullptr;     // given when a pattern finishes
+const ToneStep* volatile toneStep = nullptr;  // next step, nullptr when idle
+// Claiming the player: the loop and the alert task both start patterns
+portMUX_TYPE toneLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Audio instrumentation: CPU time spent in tone callbacks
+volatile uint32_t audioCpuMicros = 0;
+volatile uint32_t audioCallbacks = 0;
+
+void applyToneStep(const ToneStep& step) {
+    if (step.frequency != 0) {
+        if (buzzerEnabled) {
+            ledcWriteTone(0, step.frequency);
+        }
+        ledOn();
+    } else {
+        ledcWrite(0, 0);
+        ledOff();
     }
 }
 
-void singleBeep() {
-    if (buzzerEnabled) {
-        ledcWrite(0, BUZZER_DUTY);
-    }
-    ledOn();
-    delay(BEEP_DURATION);
-    if (buzzerEnabled) {
+void toneTimerCallback(void* arg) {
+    int64_t start = esp_timer_get_time();
+    
+    const ToneStep* step = toneStep;
+    if (step == nullptr || step->durationMs == 0) {
         ledcWrite(0, 0);
-        digitalBeep(BEEP_DURATION);
+        ledOff();
+        toneStep = nullptr;
+        xSemaphoreGive(toneDone);
+    } else {
+        applyToneStep(*step);
+        toneStep = step + 1;
+        esp_timer_start_once(toneTimer, (uint64_t)step->durationMs * 1000);
+    }
+    
+    audioCpuMicros += (uint32_t)(esp_timer_get_time() - start);
+    audioCallbacks++;
+}
+
+// Starts a pattern and returns immediately. Returns false if one is
+// already playing.
+bool playTonePattern(const ToneStep* pattern) {
+    if (toneTimer == nullptr) return false;
+    
+    portENTER_CRITICAL(&toneLock);
+    bool idle = toneStep == nullptr;
+    if (idle) toneStep = pattern;
+    portEXIT_CRITICAL(&toneLock);
+    if (!idle) return false;
+    
+    xSemaphoreTake(toneDone, 0);
+    toneTimerCallback(nullptr);
+    return true;
+}
+
+// Blocks the calling task (not the CPU) until the current pattern ends
+void waitForTonePattern() {
+    if (toneStep != nullptr) {
+        xSemaphoreTake(toneDone, portMAX_DELAY);
     }
-    ledOff();
+}
+
+void initializeTonePlayer() {
+    toneDone = xSemaphoreCreateBinary();
+    
+    esp_timer_create_args_t args = {};
+    args.callback = toneTimerCallback;
+    args.name = "tone";
+    esp_timer_create(&args, &toneTimer);
+}
+
+void singleBeep() {
+    playTonePattern(PATTERN_SINGLE_BEEP);
+}
+
+void twoBeeps() {
+    playTonePattern(PATTERN_TWO_BEEPS);
 }
 
 void threeBeeps() {
     // Start detection flash animation
     startDetectionFlash();
-    
-    for(int i = 0; i < 3; i++) {
-        singleBeep();
-        if (i < 2) delay(BEEP_PAUSE);
-    }
+    playTonePattern(PATTERN_THREE_BEEPS);
+}
+
+void ascendingBeeps() {
+    playTonePattern(PATTERN_ASCENDING);
 }
 
 // ================================
 // NeoPixel Functions
 // ================================
+// WS2812 output through the RMT peripheral. A frame is encoded into the
+// back buffer (GRB, brightness applied) and handed to the RMT driver,
+// which converts and clocks it out from its own interrupt while the CPU
+// carries on; the buffers swap so the next frame never touches the one
+// being sent. Nothing here disables interrupts or waits for the bus.
+
+// 800 kHz WS2812 bit timings in 25 ns RMT ticks (80 MHz APB / 2)
+#define WS2812_T0H 16   // 400 ns
+#define WS2812_T0L 34   // 850 ns
+#define WS2812_T1H 32   // 800 ns
+#define WS2812_T1L 18   // 450 ns
+
+uint8_t pixelBuffers[2][NEOPIXEL_COUNT * 3];
+uint8_t backBuffer = 0;
+bool pixelFramePending = false;   // back buffer filled but not yet sent
+bool pixelOutputReady = false;
+uint32_t framesDeferred = 0;      // frames that waited for the previous transfer
+
+constexpr uint32_t rmtItem(uint16_t highTicks, uint16_t lowTicks) {
+    return (uint32_t)highTicks | (1UL << 15) | ((uint32_t)lowTicks << 16);
+}
+
+// Called by the RMT driver, from its interrupt, as it needs more items.
+// The interrupt is allocated in IRAM so frames keep going while flash is
+// busy with NVS or journal writes; the translator is in IRAM with it and
+// its items are compile-time constants, so it never touches flash.
+void IRAM_ATTR ws2812Translator(const void* src, rmt_item32_t* dest, size_t srcSize,
+                                size_t wantedNum, size_t* translatedSize, size_t* itemNum) {
+    constexpr uint32_t bit0 = rmtItem(WS2812_T0H, WS2812_T0L);
+    constexpr uint32_t bit1 = rmtItem(WS2812_T1H, WS2812_T1L);
+    const uint8_t* in = (const uint8_t*)src;
+    size_t size = 0;
+    size_t num = 0;
+    
+    while (size < srcSize && num + 8 <= wantedNum) {
+        for (int bit = 7; bit >= 0; bit--) {
+            dest[num++].val = (in[size] & (1 << bit)) ? bit1 : bit0;
+        }
+        size++;
+    }
+    *translatedSize = size;
+    *itemNum = num;
+}
+
+void initializeNeoPixelOutput() {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)NEOPIXEL_PIN, NEOPIXEL_RMT_CHANNEL);
+    config.clk_div = 2;
+    if (rmt_config(&config) != ESP_OK) return;
+    if (rmt_driver_install(NEOPIXEL_RMT_CHANNEL, 0, ESP_INTR_FLAG_IRAM) != ESP_OK) return;
+    rmt_translator_init(NEOPIXEL_RMT_CHANNEL, ws2812Translator);
+    pixelOutputReady = true;
+}
+
+// Starts sending the back buffer if the bus is free; otherwise leaves it
+// pending for the next call. Only the newest pending frame is ever sent.
+void flushNeoPixel() {
+    if (!pixelFramePending || !pixelOutputReady) return;
+    if (rmt_wait_tx_done(NEOPIXEL_RMT_CHANNEL, 0) != ESP_OK) return;
+    
+    rmt_write_sample(NEOPIXEL_RMT_CHANNEL, pixelBuffers[backBuffer], sizeof(pixelBuffers[0]), false);
+    backBuffer ^= 1;
+    pixelFramePending = false;
+}
+
+// Colours are 0xRRGGBB; NEOPIXEL_BRIGHTNESS caps every channel
+void showNeoPixelFrame(const uint32_t* colors) {
+    if (pixelFramePending) framesDeferred++;
+    
+    uint8_t* out = pixelBuffers[backBuffer];
+    for (int i = 0; i < NEOPIXEL_COUNT; i++) {
+        *out++ = scale8((uint8_t)(colors[i] >> 8), NEOPIXEL_BRIGHTNESS);   // G
+        *out++ = scale8((uint8_t)(colors[i] >> 16), NEOPIXEL_BRIGHTNESS);  // R
+        *out++ = scale8((uint8_t)colors[i], NEOPIXEL_BRIGHTNESS);          // B
+    }
+    pixelFramePending = true;
+    flushNeoPixel();
+}
+
 void initializeNeoPixel() {
-    strip.begin();
-    strip.setBrightness(NEOPIXEL_BRIGHTNESS);
-    strip.clear();
-    strip.show();
+    initializeNeoPixelOutput();
+    uint32_t off[NEOPIXEL_COUNT] = {0};
+    showNeoPixelFrame(off);
     startupAnimationTime = millis();
     startupAnimationComplete = false;
 }
@@ -223,7 +474,34 @@ uint32_t hsvToRgb(uint16_t h, uint8_t s, uint8_t v) {
         }
     }
     
-    return strip.Color(r, g, b);
+    return packRGB(r, g, b);
+}
+
+// Animations render into frame[] once per ANIMATION_FRAME_MS;
+// presentFrame() only hands it to the output when something changed.
+// Colours are 0xRRGGBB, all maths is integer (Q8 brightness, Q8 phase).
+uint32_t frame[NEOPIXEL_COUNT];
+uint32_t shownFrame[NEOPIXEL_COUNT];
+bool shownFrameValid = false;
+uint32_t framesRendered = 0;
+uint32_t framesSkipped = 0;
+
+void presentFrame() {
+    framesRendered++;
+    if (shownFrameValid && memcmp(frame, shownFrame, sizeof(frame)) == 0) {
+        framesSkipped++;
+        return;
+    }
+    
+    showNeoPixelFrame(frame);
+    memcpy(shownFrame, frame, sizeof(frame));
+    shownFrameValid = true;
+}
+
+void fillFrame(uint32_t color) {
+    for (int i = 0; i < NEOPIXEL_COUNT; i++) {
+        frame[i] = color;
+    }
 }
 
 void startupAnimation() {
@@ -233,91 +511,78 @@ void startupAnimation() {
     
     // Progress bar showing config time elapsed
     // Wraps around every 25 seconds for visual variety
-    float progress = (float)(elapsed % 25000) / 25000.0;
-    int litPixels = (int)(progress * NEOPIXEL_COUNT);
+    int litPixels = (elapsed % 25000) * NEOPIXEL_COUNT / 25000;
     
     // Color cycles through spectrum
     uint16_t baseHue = ((elapsed / 120) % 360) * 256 / 360;
+    uint32_t emptyColor = hsvToRgb(baseHue, 100, 2);
     
     for (int i = 0; i < NEOPIXEL_COUNT; i++) {
         if (i < litPixels) {
             // Filled portion
             uint8_t brightness = NEOPIXEL_BRIGHTNESS / 3;
             uint16_t hue = baseHue + (i * 10);
-            strip.setPixelColor(i, hsvToRgb(hue, 255, brightness));
+            frame[i] = hueColor(hue, brightness);
         } else if (i == litPixels) {
-            // Leading edge - pulsing
-            float pulse = sin(millis() * 0.009) * 0.5 + 0.5;
-            uint8_t brightness = (uint8_t)(NEOPIXEL_BRIGHTNESS * pulse / 2);
-            strip.setPixelColor(i, hsvToRgb(baseHue, 255, brightness));
+            // Leading edge - pulsing, ~700 ms period (256 phase steps per 698 ms)
+            uint8_t pulse = sine8((uint8_t)((millis() * 375) >> 10));
+            uint8_t brightness = (NEOPIXEL_BRIGHTNESS * pulse) >> 9;
+            frame[i] = hueColor(baseHue, brightness);
         } else {
             // Empty portion - very dim
-            strip.setPixelColor(i, hsvToRgb(baseHue, 100, 2));
+            frame[i] = emptyColor;
         }
     }
-    
-    strip.show();
 }
 
-// Normal scanning animation: flowing wave pattern
+// Normal scanning animation: flowing wave pattern, advanced once per frame
 void normalScanningAnimation() {
-    static unsigned long lastUpdate = 0;
-    static float colorPhase = 0.0;
-    static float wavePosition = 0.0;
+    static uint16_t colorPhase = 0;    // half degrees, 0-719
+    static uint16_t wavePosition = 0;  // Q8 pixels, 0 to NEOPIXEL_COUNT
     
-    unsigned long currentTime = millis();
+    // Map RSSI to bar display
+    int signalBars = map(constrain(averageRSSI, -100, -30), -100, -30, 0, NEOPIXEL_COUNT);
+    signalBars = constrain(signalBars, 0, NEOPIXEL_COUNT);
     
-    if (currentTime - lastUpdate >= 30) {
-        lastUpdate = currentTime;
-        
-        // Map RSSI to bar display
-        int signalBars = map(constrain(averageRSSI, -100, -30), -100, -30, 0, NEOPIXEL_COUNT);
-        signalBars = constrain(signalBars, 0, NEOPIXEL_COUNT);
-        
-        // Move wave
-        wavePosition += 0.25;
-        if (wavePosition >= NEOPIXEL_COUNT) wavePosition = 0.0;
-        
-        // Cycle colors
-        colorPhase += 0.5;
-        if (colorPhase >= 360) colorPhase = 0.0;
-        
-        uint16_t baseHue;
-        if (colorPhase < 72) {
-            baseHue = 120; // Green
-        } else if (colorPhase < 144) {
-            baseHue = 180; // Cyan
-        } else if (colorPhase < 216) {
-            baseHue = 240; // Blue
-        } else if (colorPhase < 288) {
-            baseHue = 270; // Purple
-        } else {
-            baseHue = 300; // Pink
-        }
+    // Move wave a quarter pixel per frame
+    wavePosition += 64;
+    if (wavePosition >= NEOPIXEL_COUNT * 256) wavePosition = 0;
+    
+    // Cycle colors
+    colorPhase += 1;
+    if (colorPhase >= 720) colorPhase = 0;
+    
+    uint16_t baseHue;
+    if (colorPhase < 144) {
+        baseHue = 120; // Green
+    } else if (colorPhase < 288) {
+        baseHue = 180; // Cyan
+    } else if (colorPhase < 432) {
+        baseHue = 240; // Blue
+    } else if (colorPhase < 576) {
+        baseHue = 270; // Purple
+    } else {
+        baseHue = 300; // Pink
+    }
+    
+    for (int i = 0; i < NEOPIXEL_COUNT; i++) {
+        // Sine wave at this position: one period across the strip
+        uint8_t wavePhase = (uint8_t)((wavePosition + i * 256) / NEOPIXEL_COUNT);
+        uint8_t waveValue = sine8(wavePhase); // Q8, 0-255
         
-        for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-            // Calculate sine wave at this position
-            float wavePhase = (wavePosition + i) / (float)NEOPIXEL_COUNT * PI * 2;
-            float waveValue = sin(wavePhase) * 0.5 + 0.5; // 0-1 range
+        if (i < signalBars) {
+            // Lit segment - wave modulates brightness
+            uint8_t baseBrightness = NEOPIXEL_BRIGHTNESS / 2;
+            uint8_t finalBrightness = baseBrightness + ((baseBrightness * waveValue) >> 8);
             
-            if (i < signalBars) {
-                // Lit segment - wave modulates brightness
-                uint8_t baseBrightness = NEOPIXEL_BRIGHTNESS / 2;
-                uint8_t waveBrightness = (uint8_t)(baseBrightness * waveValue);
-                uint8_t finalBrightness = baseBrightness + waveBrightness;
-                
-                // Hue shifts with wave
-                uint16_t pixelHue = baseHue + (i * 5) + (uint16_t)(waveValue * 30);
-                
-                strip.setPixelColor(i, hsvToRgb(pixelHue, 255, finalBrightness));
-            } else {
-                // Dark segment - wave is barely visible
-                uint8_t dimBrightness = (uint8_t)(waveValue * 10);
-                strip.setPixelColor(i, hsvToRgb(baseHue, 255, dimBrightness));
-            }
+            // Hue shifts with wave
+            uint16_t pixelHue = baseHue + (i * 5) + ((waveValue * 30) >> 8);
+            
+            frame[i] = hueColor(pixelHue, finalBrightness);
+        } else {
+            // Dark segment - wave is barely visible
+            frame[i] = hueColor(baseHue, (waveValue * 10) >> 8);
         }
-        
-        strip.show();
     }
 }
 
@@ -333,6 +598,7 @@ void detectionAnimation() {
     
     if (cycle >= 3) {
         detectionMode = false;
+        normalScanningAnimation();
         return;
     }
     
@@ -340,67 +606,47 @@ void detectionAnimation() {
     uint16_t currentHue = colors[cycle];
     
     if (cycleProgress < FLASH_DURATION) {
-        // Explosion phase: burst from center outward
-        float progress = (float)cycleProgress / FLASH_DURATION;
-        float radius = progress * 4.0;
+        // Explosion phase: burst from center outward. Distances are in
+        // half pixels so the centre between the two middle pixels is exact.
+        int radius = cycleProgress * NEOPIXEL_COUNT / FLASH_DURATION;
         
         for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-            float distance = abs(i - 3.5);
+            int distance = abs(2 * i - (NEOPIXEL_COUNT - 1));
             
             if (distance <= radius) {
-                float intensity = 1.0 - (distance / radius) * 0.5;
-                uint8_t brightness = (uint8_t)(NEOPIXEL_DETECTION_BRIGHTNESS * intensity);
-                strip.setPixelColor(i, hsvToRgb(currentHue, 255, brightness));
+                // Full intensity at the centre, half at the burst edge (Q8)
+                uint16_t intensity = 256 - (distance * 128) / radius;
+                uint8_t brightness = (NEOPIXEL_DETECTION_BRIGHTNESS * intensity) >> 8;
+                frame[i] = hueColor(currentHue, brightness);
             } else {
-                strip.setPixelColor(i, 0);
+                frame[i] = 0;
             }
         }
     } else {
-        // Fade phase
-        float fadeProgress = (float)(cycleProgress - FLASH_DURATION) / PAUSE_DURATION;
-        uint8_t brightness = (uint8_t)(NEOPIXEL_BRIGHTNESS * (1.0 - fadeProgress) * 0.3);
-        
-        for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-            strip.setPixelColor(i, hsvToRgb(currentHue, 255, brightness));
-        }
+        // Fade phase: 30% brightness falling to zero
+        unsigned long remaining = CYCLE_DURATION - cycleProgress;
+        uint8_t brightness = (NEOPIXEL_BRIGHTNESS * 77 * remaining) / (PAUSE_DURATION * 256);
+        fillFrame(hueColor(currentHue, brightness));
     }
-    
-    strip.show();
 }
 
 
 // Normal pink breathing animation
 void normalBreathingAnimation() {
-    static unsigned long lastUpdate = 0;
-    static float brightness = 0.0;
+    static uint8_t brightness = 26;  // Q8, 0.1-1.0
     static bool increasing = true;
     
-    unsigned long currentTime = millis();
-    
-    // Update every 20ms for smooth animation
-    if (currentTime - lastUpdate >= 20) {
-        lastUpdate = currentTime;
-        
-        // Update brightness (breathing effect)
-        if (increasing) {
-            brightness += 0.02;
-            if (brightness >= 1.0) {
-                brightness = 1.0;
-                increasing = false;
-            }
-        } else {
-            brightness -= 0.02;
-            if (brightness <= 0.1) {
-                brightness = 0.1;
-                increasing = true;
-            }
-        }
-        
-        // Pink color (hue 300) with breathing brightness
-        uint32_t color = hsvToRgb(300, 255, (uint8_t)(NEOPIXEL_BRIGHTNESS * brightness));
-        strip.setPixelColor(0, color);
-        strip.show();
+    // Update brightness (breathing effect), ~0.02 per 20 ms
+    if (increasing) {
+        brightness = brightness > 255 - 8 ? 255 : brightness + 8;
+        if (brightness == 255) increasing = false;
+    } else {
+        brightness = brightness < 26 + 8 ? 26 : brightness - 8;
+        if (brightness == 26) increasing = true;
     }
+    
+    // Pink color (hue 300) with breathing brightness
+    frame[0] = hueColor(300, (NEOPIXEL_BRIGHTNESS * brightness) >> 8);
 }
 
 // Detection flash animation synchronized with beeps
@@ -432,10 +678,7 @@ void detectionFlashAnimation() {
         brightness = NEOPIXEL_BRIGHTNESS / 4;
     }
     
-    // Set color
-    uint32_t color = hsvToRgb(hue, 255, brightness);
-    strip.setPixelColor(0, color);
-    strip.show();
+    frame[0] = hueColor(hue, brightness);
     
     // End detection mode after 3 flashes (same as threeBeeps)
     if (elapsed >= (BEEP_DURATION + BEEP_PAUSE) * 3) {
@@ -443,8 +686,14 @@ void detectionFlashAnimation() {
     }
 }
 
-// Main animation function
+// Main animation function: renders at most one frame per ANIMATION_FRAME_MS
 void updateNeoPixelAnimation() {
+    static unsigned long lastFrameTime = 0;
+    unsigned long currentTime = millis();
+    flushNeoPixel();
+    if (currentTime - lastFrameTime < ANIMATION_FRAME_MS) return;
+    lastFrameTime = currentTime;
+    
     if (!startupAnimationComplete) {
         startupAnimation();
     } else if (detectionMode) {
@@ -452,352 +701,2336 @@ void updateNeoPixelAnimation() {
     } else {
         normalScanningAnimation();
     }
+    presentFrame();
 }
 
 void setNeoPixelColor(uint8_t r, uint8_t g, uint8_t b) {
-    for (int i = 0; i < NEOPIXEL_COUNT; i++) {
-        strip.setPixelColor(i, strip.Color(r, g, b));
-    }
-    strip.show();
+    fillFrame(packRGB(r, g, b));
+    presentFrame();
 }
 
 void turnOffNeoPixel() {
-    strip.clear();
-    strip.show();
+    fillFrame(0);
+    presentFrame();
 }
 
 void startDetectionFlash() {
     detectionMode = true;
     detectionStartTime = millis();
 }
-void twoBeeps() {
-    for(int i = 0; i < 2; i++) {
-        singleBeep();
-        if (i < 1) delay(BEEP_PAUSE);
-    }
-}
 
-void ascendingBeeps() {
-    // Two fast ascending beeps to indicate "ready to scan"
-    int frequencies[] = {1900, 2200}; // Close melodic interval, not octave
-    int fastPause = 100; // Faster than normal beeps
+// ================================
+// Alert Sequencer
+// ================================
+// Beep patterns take around a second and a half to play. The BLE callback
+// only records the alert; a low-priority task starts the pattern and
+// sleeps until it ends, so the NimBLE host task never waits on audio.
+//
+// Alerts are coalesced rather than queued one by one: everything that
+// arrives within ALERT_COALESCE_MS, or while a pattern is playing, is
+// folded into a single alert typed by its most important member
+// (NEW > RE-30s > RE-5s) and summarized as a device count plus the
+// strongest RSSI. Pending alerts older than ALERT_STALE_MS are dropped,
+// so a crowd of matches produces a few current alerts, not a backlog.
+#define ALERT_COALESCE_MS 250
+#define ALERT_STALE_MS 3000
+#define ALERT_TASK_STACK 4096  // plays patterns inline: ledc, esp_timer and the NeoPixel flash
+#define ALERT_TASK_PRIORITY 1
+#define ALERT_SUMMARY_RING_SIZE 8
+
+// Pending alerts of one detection type
+struct AlertBucket {
+    uint16_t count;
+    int8_t strongestRSSI;
+    uint32_t lastQueued;   // millis()
+};
+
+// One played alert, reported on serial by loop()
+struct AlertSummary {
+    uint32_t timestamp;    // millis() when played
+    uint16_t count;        // matches folded into this alert
+    int8_t strongestRSSI;
+    uint8_t type;          // DetectionType of the most important match
+};
+
+// Most important first
+const DetectionType ALERT_PRIORITY_ORDER[] = {DETECTION_NEW, DETECTION_RE_30S, DETECTION_RE_5S};
+
+AlertBucket pendingAlerts[3];
+portMUX_TYPE alertLock = portMUX_INITIALIZER_UNLOCKED;
+TaskHandle_t alertTaskHandle = nullptr;
+SpscRing<AlertSummary, ALERT_SUMMARY_RING_SIZE> alertSummaries;
+volatile uint32_t alertsCoalesced = 0;  // matches folded into another alert
+volatile uint32_t alertsStale = 0;      // matches whose alert expired unplayed
+
+// Folds everything pending into one summary. Returns false if nothing
+// current is pending.
+bool takePendingAlert(AlertSummary& summary) {
+    bool found = false;
+    summary.count = 0;
+    summary.strongestRSSI = INT8_MIN;
     
-    for (int i = 0; i < 2; i++) {
-        if (buzzerEnabled) {
-            ledcSetup(0, frequencies[i], 8);
-            ledcWrite(0, BUZZER_DUTY);
+    portENTER_CRITICAL(&alertLock);
+    uint32_t now = millis();
+    for (DetectionType type : ALERT_PRIORITY_ORDER) {
+        AlertBucket& bucket = pendingAlerts[type];
+        if (bucket.count == 0) continue;
+        
+        if (now - bucket.lastQueued > ALERT_STALE_MS) {
+            alertsStale += bucket.count;
+        } else {
+            if (!found) summary.type = type;
+            found = true;
+            summary.count += bucket.count;
+            if (bucket.strongestRSSI > summary.strongestRSSI) summary.strongestRSSI = bucket.strongestRSSI;
         }
-        ledOn();
-        delay(BEEP_DURATION);
-        if (buzzerEnabled) {
-            ledcWrite(0, 0);
+        bucket.count = 0;
+    }
+    portEXIT_CRITICAL(&alertLock);
+    
+    if (found) {
+        alertsCoalesced += summary.count - 1;
+        summary.timestamp = now;
+    }
+    return found;
+}
+
+void alertTask(void* param) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Let the rest of a burst arrive before deciding what to play
+        vTaskDelay(pdMS_TO_TICKS(ALERT_COALESCE_MS));
+        
+        // Matches that arrive while a pattern plays are folded into the next one
+        AlertSummary summary;
+        while (takePendingAlert(summary)) {
+            alertSummaries.push(summary);
+            if (summary.type == DETECTION_RE_5S) {
+                twoBeeps();
+            } else {
+                threeBeeps();
+            }
+            waitForTonePattern();
         }
-        ledOff();
-        if (i < 1) delay(fastPause);
     }
+}
+
+void startAlertSequencer() {
+    memset(pendingAlerts, 0, sizeof(pendingAlerts));
+    xTaskCreate(alertTask, "alerts", ALERT_TASK_STACK, nullptr, ALERT_TASK_PRIORITY, &alertTaskHandle);
+}
+
+// Never blocks; safe from the BLE callback
+void queueAlert(DetectionType type, int rssi) {
+    portENTER_CRITICAL(&alertLock);
+    AlertBucket& bucket = pendingAlerts[type];
+    if (bucket.count == 0 || rssi > bucket.strongestRSSI) bucket.strongestRSSI = (int8_t)rssi;
+    if (bucket.count < UINT16_MAX) bucket.count++;
+    bucket.lastQueued = millis();
+    portEXIT_CRITICAL(&alertLock);
     
-    // Reset to original frequency for future beeps
-    if (buzzerEnabled) {
-        ledcSetup(0, BUZZER_FREQ, 8);
+    if (alertTaskHandle != nullptr) {
+        xTaskNotifyGive(alertTaskHandle);
     }
 }
 
 // ================================
-// Configuration Storage Functions
+// MAC Address Utility Functions
 // ================================
-void saveConfiguration() {
-    preferences.begin("ouispy", false);
-    preferences.putInt("filterCount", targetFilters.size());
-    preferences.putBool("buzzerEnabled", buzzerEnabled);
-    preferences.putBool("ledEnabled", ledEnabled);
-    
-    for (int i = 0; i < targetFilters.size(); i++) {
-        String keyId = "id_" + String(i);
-        String keyMAC = "mac_" + String(i);
-        String keyDesc = "desc_" + String(i);
-        
-        preferences.putString(keyId.c_str(), targetFilters[i].identifier);
-        preferences.putBool(keyMAC.c_str(), targetFilters[i].isFullMAC);
-        preferences.putString(keyDesc.c_str(), targetFilters[i].description);
+// Text form is only produced for JSON/serial/HTML output - matching,
+// tracking and alias lookup all compare packed integers.
+String formatMAC(const MacAddr& mac, bool fullMAC = true) {
+    char buf[18];
+    mac.format(buf, fullMAC ? 6 : 3);
+    return String(buf);
+}
+
+TargetFilter makeMACFilter(const MacAddr& prefix, uint8_t prefixBits, const String& description) {
+    TargetFilter filter;
+    filter.kind = FILTER_MAC;
+    filter.identifier = prefix.masked(prefixBits);
+    filter.prefixBits = prefixBits;
+    filter.payloadId = 0;
+    filter.description = description;
+    return filter;
+}
+
+// 128-bit UUIDs in display order, split into two big-endian halves
+struct UUID128 {
+    uint64_t high;
+    uint64_t low;
+};
+
+// Bluetooth Base UUID 0000xxxx-0000-1000-8000-00805f9b34fb
+const uint64_t BLUETOOTH_BASE_UUID_HIGH = 0x0000000000001000ULL;
+const uint64_t BLUETOOTH_BASE_UUID_LOW = 0x800000805F9B34FBULL;
+
+bool parseUUID128(const String& text, UUID128& uuid) {
+    uuid.high = 0;
+    uuid.low = 0;
+    int digits = 0;
+    for (unsigned int i = 0; i < text.length(); i++) {
+        char c = text.charAt(i);
+        if (c == '-') continue;
+        int nibble = MacAddr::hexValue(c);
+        if (nibble < 0 || digits == 32) return false;
+        uint64_t& half = (digits < 16) ? uuid.high : uuid.low;
+        half = (half << 4) | (uint64_t)nibble;
+        digits++;
     }
-    
-    preferences.end();
-    
-    if (isSerialConnected()) {
-        Serial.println("Configuration saved to NVS");
+    return digits == 32;
+}
+
+String formatUUID128(const UUID128& uuid) {
+    static const char hex[] = "0123456789abcdef";
+    char buf[37];
+    int pos = 0;
+    for (int i = 0; i < 32; i++) {
+        if (i == 8 || i == 12 || i == 16 || i == 20) buf[pos++] = '-';
+        uint64_t half = (i < 16) ? uuid.high : uuid.low;
+        buf[pos++] = hex[(half >> (60 - 4 * (i % 16))) & 0x0F];
     }
+    buf[pos] = '\0';
+    return String(buf);
 }
 
-void loadConfiguration() {
-    preferences.begin("ouispy", true);
-    int filterCount = preferences.getInt("filterCount", 0);
-    buzzerEnabled = preferences.getBool("buzzerEnabled", true);
-    ledEnabled = preferences.getBool("ledEnabled", true);
+// True if the UUID is a 16-bit UUID expanded onto the Bluetooth Base UUID
+bool isBluetoothBaseUUID(const UUID128& uuid, uint16_t& uuid16) {
+    if ((uuid.high & 0xFFFF0000FFFFFFFFULL) != BLUETOOTH_BASE_UUID_HIGH ||
+        uuid.low != BLUETOOTH_BASE_UUID_LOW) {
+        return false;
+    }
+    uuid16 = (uint16_t)(uuid.high >> 32);
+    return true;
+}
+
+String formatHex16(uint16_t value) {
+    char buf[5];
+    snprintf(buf, sizeof(buf), "%04x", value);
+    return String(buf);
+}
+
+// Canonical text form, as stored in NVS and shown in the web portal
+String formatFilter(const TargetFilter& filter) {
+    switch (filter.kind) {
+        case FILTER_COMPANY_ID:  return "company:" + formatHex16(filter.payloadId);
+        case FILTER_UUID16:      return "uuid:" + formatHex16(filter.payloadId);
+        case FILTER_UUID128:     return "uuid:" + filter.pattern;
+        case FILTER_NAME_PREFIX: return "name:" + filter.pattern;
+        default: break;
+    }
+    char buf[21];
+    filter.identifier.formatPrefix(buf, filter.prefixBits);
+    return String(buf);
+}
+
+String filterTypeName(const TargetFilter& filter) {
+    switch (filter.kind) {
+        case FILTER_COMPANY_ID:  return "Company ID";
+        case FILTER_UUID16:
+        case FILTER_UUID128:     return "Service UUID";
+        case FILTER_NAME_PREFIX: return "Name prefix";
+        default: break;
+    }
+    if (filter.isFullMAC()) return "Full MAC";
+    if (filter.prefixBits == 24) return "OUI";
+    return "Prefix/" + String(filter.prefixBits);
+}
+
+// Accepts an OUI (aa:bb:cc), a full MAC, an IEEE MA-M/MA-S block
+// (aa:bb:cc:d, aa:bb:cc:dd:e) or any prefix with an explicit /bits length
+bool parseMAC(const String& text, MacAddr& mac, uint8_t& prefixBits) {
+    int bits = MacAddr::parsePrefix(text.c_str(), mac);
+    prefixBits = (uint8_t)bits;
+    return bits != 0;
+}
+
+bool parseHex16(String text, uint16_t& value) {
+    if (text.startsWith("0x") || text.startsWith("0X")) text = text.substring(2);
+    if (text.length() == 0 || text.length() > 4) return false;
+    value = 0;
+    for (unsigned int i = 0; i < text.length(); i++) {
+        int nibble = MacAddr::hexValue(text.charAt(i));
+        if (nibble < 0) return false;
+        value = (value << 4) | nibble;
+    }
+    return true;
+}
+
+// Parses any filter line: a MAC prefix, or an advertisement payload
+// filter "company:004c", "uuid:fd5a", "uuid:<128-bit uuid>", "name:<prefix>"
+bool parseFilterSpec(const String& text, TargetFilter& filter) {
+    filter.kind = FILTER_MAC;
+    filter.identifier = MacAddr();
+    filter.prefixBits = 0;
+    filter.payloadId = 0;
+    filter.pattern = "";
     
-    targetFilters.clear();
+    int colon = text.indexOf(':');
+    String scheme = colon > 0 ? text.substring(0, colon) : "";
+    scheme.toLowerCase();
+    String value = text.substring(colon + 1);
+    value.trim();
     
-    // Load saved filters or use defaults
-    if (filterCount > 0) {
-        for (int i = 0; i < filterCount; i++) {
-            String keyId = "id_" + String(i);
-            String keyMAC = "mac_" + String(i);
-            String keyDesc = "desc_" + String(i);
-            
-            TargetFilter filter;
-            filter.identifier = preferences.getString(keyId.c_str(), "");
-            filter.isFullMAC = preferences.getBool(keyMAC.c_str(), false);
-            filter.description = preferences.getString(keyDesc.c_str(), "");
-            
-            if (filter.identifier.length() > 0) {
-                targetFilters.push_back(filter);
+    if (scheme == "company" || scheme == "cid") {
+        filter.kind = FILTER_COMPANY_ID;
+        return parseHex16(value, filter.payloadId);
+    }
+    if (scheme == "uuid") {
+        UUID128 uuid;
+        if (value.length() > 6) {
+            if (!parseUUID128(value, uuid)) return false;
+            // A base UUID is matched in whichever width the advert uses
+            if (isBluetoothBaseUUID(uuid, filter.payloadId)) {
+                filter.kind = FILTER_UUID16;
+            } else {
+                filter.kind = FILTER_UUID128;
+                filter.pattern = formatUUID128(uuid);
             }
+            return true;
         }
-    } else {
-        // Default configuration
-        targetFilters.push_back({"AA:BB:CC", false, "Example Manufacturer"});
-        targetFilters.push_back({"DD:EE:FF", false, "Another Manufacturer"});
-        targetFilters.push_back({"AA:BB:CC:12:34:56", true, "Specific Device"});
+        filter.kind = FILTER_UUID16;
+        return parseHex16(value, filter.payloadId);
+    }
+    if (scheme == "name") {
+        filter.kind = FILTER_NAME_PREFIX;
+        filter.pattern = text.substring(colon + 1);  // names keep their spaces
+        return filter.pattern.length() > 0 && filter.pattern.length() <= 31;
     }
     
-    preferences.end();
+    return parseMAC(text, filter.identifier, filter.prefixBits);
 }
 
-void loadWiFiCredentials() {
-    preferences.begin("ouispy", true);
-    AP_SSID = preferences.getString("ap_ssid", "snoopuntothem");
-    AP_PASSWORD = preferences.getString("ap_password", "astheysnoopuntous");
-    preferences.end();
+String defaultFilterDescription(const TargetFilter& filter) {
+    switch (filter.kind) {
+        case FILTER_COMPANY_ID:  return "Company ID: 0x" + formatHex16(filter.payloadId);
+        case FILTER_UUID16:      return "Service UUID: " + formatHex16(filter.payloadId);
+        case FILTER_UUID128:     return "Service UUID: " + filter.pattern;
+        case FILTER_NAME_PREFIX: return "Name: " + filter.pattern;
+        default: break;
+    }
+    String label = filter.isFullMAC() ? "MAC" : (filter.prefixBits == 24 ? "OUI" : "Prefix");
+    return label + ": " + formatFilter(filter);
 }
 
-void saveWiFiCredentials() {
-    preferences.begin("ouispy", false);
-    preferences.putString("ap_ssid", AP_SSID);
-    preferences.putString("ap_password", AP_PASSWORD);
+bool isValidMAC(const String& mac) {
+    MacAddr parsed;
+    return MacAddr::parsePrefix(mac.c_str(), parsed) != 0;
+}
+
+// ================================
+// Compiled Filter Index
+// ================================
+// targetFilters is the editable list; the index is what onResult consults.
+// Rebuild it with rebuildFilterIndex() whenever targetFilters changes.
+//
+// Full MACs live in a hash set. Shorter prefixes live in one sorted array,
+// grouped by prefix length from longest to shortest, so the first group
+// that hits is the longest (most specific) match. Lookup is at most one
+// binary search per distinct prefix length and never allocates.
+#define MAX_TARGET_FILTERS 0xFFFF  // index entries hold filter positions as uint16_t
+
+// Match descriptions are interned when filters and IRKs are compiled, so
+// a sighting only copies a one-byte index. The table is reserved up front
+// and only ever appended to, so indexes and c_str() pointers stay valid
+// for the whole boot; devices restored from history add theirs on load.
+// Past DESCRIPTION_TABLE_SIZE distinct texts, new ones get NO_DESCRIPTION.
+#define DESCRIPTION_TABLE_SIZE 255
+#define NO_DESCRIPTION 0xFF
+
+std::vector<String> deviceDescriptions;
+uint8_t builtinDescriptionIds[OUI_DB_VENDOR_COUNT];  // per enabled built-in vendor
+
+uint8_t internDescription(const String& description) {
+    if (description.length() == 0) return NO_DESCRIPTION;
+    for (size_t i = 0; i < deviceDescriptions.size(); i++) {
+        if (deviceDescriptions[i] == description) return (uint8_t)i;
+    }
+    if (deviceDescriptions.size() >= DESCRIPTION_TABLE_SIZE) return NO_DESCRIPTION;
+    deviceDescriptions.push_back(description);
+    return (uint8_t)(deviceDescriptions.size() - 1);
+}
+
+const String& descriptionText(uint8_t index) {
+    static const String none;
+    return index < deviceDescriptions.size() ? deviceDescriptions[index] : none;
+}
+
+struct PrefixIndexEntry {
+    uint64_t prefix;  // masked to the group's length
+    uint16_t filter;  // index into targetFilters
+};
+
+struct PrefixGroup {
+    uint8_t bits;
+    uint16_t begin;   // range in prefixIndex
+    uint16_t end;
+};
+
+struct MACIndexSlot {
+    uint64_t mac;     // EMPTY_MAC_SLOT when unused
+    uint16_t filter;
+};
+
+const uint64_t EMPTY_MAC_SLOT = UINT64_MAX;  // never a valid 48-bit MAC
+
+std::vector<PrefixIndexEntry> prefixIndex;
+std::vector<PrefixGroup> prefixGroups;       // longest prefix first
+std::vector<MACIndexSlot> macIndex;          // open addressing, power-of-two size
+uint32_t macIndexMask = 0;
+
+inline uint32_t hashMAC(uint64_t mac) {
+    // Fibonacci hashing - spreads sequential device MACs across the table
+    return (uint32_t)((mac * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+// Fast-reject stage: a bloom filter over the leading bits of every user
+// filter and enabled built-in vendor OUI. The key is the top 24 bits, or
+// fewer when a shorter prefix filter exists. A miss proves nothing can
+// match, so the vast majority of adverts never reach the exact index.
+#define PREFIX_BLOOM_BITS_PER_ENTRY 16   // ~1.5% false positives with 2 probes
+#define PREFIX_BLOOM_MIN_BITS 256
+#define PREFIX_BLOOM_MAX_BITS 65536      // 8KB cap for very large filter sets
+
+std::vector<uint32_t> prefixBloom;
+uint32_t prefixBloomMask = 0;            // bit count - 1
+uint8_t prefixBloomKeyBits = 24;
+
+// Advert counters (written only by the BLE callback)
+volatile uint32_t advertsChecked = 0;
+volatile uint32_t advertsFastRejected = 0;
+
+inline uint64_t hashPrefix(uint64_t key) {
+    uint64_t x = key;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline void prefixBloomAdd(const MacAddr& mac) {
+    uint64_t h = hashPrefix(mac.value >> (48 - prefixBloomKeyBits));
+    uint32_t a = (uint32_t)h & prefixBloomMask;
+    uint32_t b = (uint32_t)(h >> 32) & prefixBloomMask;
+    prefixBloom[a >> 5] |= (1UL << (a & 31));
+    prefixBloom[b >> 5] |= (1UL << (b & 31));
+}
+
+inline bool prefixBloomMayContain(const MacAddr& mac) {
+    uint64_t h = hashPrefix(mac.value >> (48 - prefixBloomKeyBits));
+    uint32_t a = (uint32_t)h & prefixBloomMask;
+    uint32_t b = (uint32_t)(h >> 32) & prefixBloomMask;
+    return (prefixBloom[a >> 5] & (1UL << (a & 31))) &&
+           (prefixBloom[b >> 5] & (1UL << (b & 31)));
+}
+
+void rebuildPrefixBloom() {
+    size_t entries = 0;
+    prefixBloomKeyBits = 24;
+    for (const TargetFilter& filter : targetFilters) {
+        if (!filter.isMAC()) continue;
+        entries++;
+        if (filter.prefixBits < prefixBloomKeyBits) prefixBloomKeyBits = filter.prefixBits;
+    }
+    for (int i = 0; i < OUI_DB_SIZE; i++) {
+        if (builtinVendorMask & (1UL << OUI_DB[i].vendor)) entries++;
+    }
+    
+    uint32_t bits = PREFIX_BLOOM_MIN_BITS;
+    while (bits < entries * PREFIX_BLOOM_BITS_PER_ENTRY && bits < PREFIX_BLOOM_MAX_BITS) bits <<= 1;
+    prefixBloom.assign(bits / 32, 0);
+    prefixBloomMask = bits - 1;
+    
+    for (const TargetFilter& filter : targetFilters) {
+        if (filter.isMAC()) prefixBloomAdd(filter.identifier);
+    }
+    for (int i = 0; i < OUI_DB_SIZE; i++) {
+        if (builtinVendorMask & (1UL << OUI_DB[i].vendor)) {
+            prefixBloomAdd(MacAddr((uint64_t)OUI_DB[i].oui << 24));
+        }
+    }
+}
+
+// Advertisement payload filters: company IDs and service UUIDs share one
+// open-addressing table keyed by (kind, value), so an advert costs one
+// probe per UUID/company ID it carries. Name prefixes are few and are
+// compared in place against the raw name bytes.
+struct PayloadIndexSlot {
+    uint64_t high;     // 16-bit ID, or high half of a 128-bit UUID
+    uint64_t low;      // low half of a 128-bit UUID, 0 otherwise
+    uint16_t filter;
+    FilterKind kind;   // FILTER_MAC marks an empty slot
+};
+
+struct NameIndexEntry {
+    const char* prefix;  // points into targetFilters[filter].pattern
+    uint8_t length;
+    uint16_t filter;
+};
+
+std::vector<PayloadIndexSlot> payloadIndex;
+uint32_t payloadIndexMask = 0;
+std::vector<NameIndexEntry> nameIndex;
+size_t payloadFilterCount = 0;
+
+inline uint32_t findPayloadSlot(FilterKind kind, uint64_t high, uint64_t low) {
+    uint32_t slot = hashMAC(high ^ (low * 31) ^ kind) & payloadIndexMask;
+    while (payloadIndex[slot].kind != FILTER_MAC &&
+           (payloadIndex[slot].kind != kind || payloadIndex[slot].high != high || payloadIndex[slot].low != low)) {
+        slot = (slot + 1) & payloadIndexMask;
+    }
+    return slot;
+}
+
+// Returns the filter for a company ID / UUID, or nullptr
+const TargetFilter* findPayloadFilter(FilterKind kind, uint64_t high, uint64_t low = 0) {
+    const PayloadIndexSlot& slot = payloadIndex[findPayloadSlot(kind, high, low)];
+    return slot.kind == FILTER_MAC ? nullptr : &targetFilters[slot.filter];
+}
+
+void rebuildPayloadIndex() {
+    payloadIndex.clear();
+    nameIndex.clear();
+    payloadFilterCount = 0;
+    
+    size_t keyedCount = 0;
+    for (const TargetFilter& filter : targetFilters) {
+        if (!filter.isMAC() && filter.kind != FILTER_NAME_PREFIX) keyedCount++;
+    }
+    
+    size_t capacity = 8;
+    while (capacity < keyedCount * 2) capacity <<= 1;
+    payloadIndex.assign(capacity, {0, 0, 0, FILTER_MAC});
+    payloadIndexMask = capacity - 1;
+    
+    for (size_t i = 0; i < targetFilters.size(); i++) {
+        const TargetFilter& filter = targetFilters[i];
+        uint64_t high = filter.payloadId;
+        uint64_t low = 0;
+        
+        if (filter.isMAC()) {
+            continue;
+        } else if (filter.kind == FILTER_NAME_PREFIX) {
+            nameIndex.push_back({filter.pattern.c_str(), (uint8_t)filter.pattern.length(), (uint16_t)i});
+            payloadFilterCount++;
+            continue;
+        } else if (filter.kind == FILTER_UUID128) {
+            UUID128 uuid;
+            if (!parseUUID128(filter.pattern, uuid)) continue;
+            high = uuid.high;
+            low = uuid.low;
+        }
+        
+        // First filter in the list wins on duplicates
+        uint32_t slot = findPayloadSlot(filter.kind, high, low);
+        if (payloadIndex[slot].kind == FILTER_MAC) {
+            payloadIndex[slot] = {high, low, (uint16_t)i, filter.kind};
+        }
+        payloadFilterCount++;
+    }
+}
+
+String describeBuiltinVendor(uint8_t vendor) {
+    const OUIVendor& info = OUI_DB_VENDORS[vendor];
+    return String(info.name) + " (" + info.category + ")";
+}
+
+void rebuildFilterIndex() {
+    for (TargetFilter& filter : targetFilters) {
+        filter.descriptionId = internDescription(filter.description);
+    }
+    for (int i = 0; i < OUI_DB_VENDOR_COUNT; i++) {
+        builtinDescriptionIds[i] = (builtinVendorMask & (1UL << i)) ?
+            internDescription("Built-in: " + describeBuiltinVendor(i)) : NO_DESCRIPTION;
+    }
+    
+    prefixIndex.clear();
+    prefixGroups.clear();
+    macIndex.clear();
+    
+    size_t macCount = 0;
+    size_t prefixCount = 0;
+    for (const TargetFilter& filter : targetFilters) {
+        if (filter.isFullMAC()) macCount++;
+        else if (filter.isMAC()) prefixCount++;
+    }
+    
+    // Keep the MAC table at most half full so probe chains stay short
+    size_t capacity = 8;
+    while (capacity < macCount * 2) capacity <<= 1;
+    macIndex.assign(capacity, {EMPTY_MAC_SLOT, 0});
+    macIndexMask = capacity - 1;
+    
+    std::vector<uint8_t> prefixBits;
+    prefixIndex.reserve(prefixCount);
+    prefixBits.reserve(prefixCount);
+    
+    for (size_t i = 0; i < targetFilters.size(); i++) {
+        const TargetFilter& filter = targetFilters[i];
+        
+        if (filter.isFullMAC()) {
+            uint64_t mac = filter.identifier.value;
+            uint32_t slot = hashMAC(mac) & macIndexMask;
+            while (macIndex[slot].mac != EMPTY_MAC_SLOT && macIndex[slot].mac != mac) {
+                slot = (slot + 1) & macIndexMask;
+            }
+            // First filter in the list wins on duplicates
+            if (macIndex[slot].mac == EMPTY_MAC_SLOT) {
+                macIndex[slot] = {mac, (uint16_t)i};
+            }
+        } else if (filter.isMAC()) {
+            prefixIndex.push_back({filter.identifier.masked(filter.prefixBits).value, (uint16_t)i});
+            prefixBits.push_back(filter.prefixBits);
+        }
+    }
+    
+    // Order by length (longest first) then prefix; stable so list order
+    // decides among duplicates, which are then dropped
+    std::vector<uint16_t> order(prefixIndex.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) {
+        if (prefixBits[a] != prefixBits[b]) return prefixBits[a] > prefixBits[b];
+        return prefixIndex[a].prefix < prefixIndex[b].prefix;
+    });
+    
+    std::vector<PrefixIndexEntry> sorted;
+    sorted.reserve(order.size());
+    for (uint16_t i : order) {
+        uint8_t bits = prefixBits[i];
+        if (prefixGroups.empty() || prefixGroups.back().bits != bits) {
+            prefixGroups.push_back({bits, (uint16_t)sorted.size(), (uint16_t)sorted.size()});
+        } else if (sorted.back().prefix == prefixIndex[i].prefix) {
+            continue;
+        }
+        sorted.push_back(prefixIndex[i]);
+        prefixGroups.back().end = sorted.size();
+    }
+    prefixIndex.swap(sorted);
+    
+    rebuildPrefixBloom();
+    rebuildPayloadIndex();
+}
+
+// Returns the full-MAC filter for this exact address, or nullptr
+const TargetFilter* findExactMACFilter(const MacAddr& deviceMAC) {
+    if (macIndex.empty()) return nullptr;
+    
+    uint32_t slot = hashMAC(deviceMAC.value) & macIndexMask;
+    while (macIndex[slot].mac != EMPTY_MAC_SLOT) {
+        if (macIndex[slot].mac == deviceMAC.value) {
+            return &targetFilters[macIndex[slot].filter];
+        }
+        slot = (slot + 1) & macIndexMask;
+    }
+    return nullptr;
+}
+
+// Returns the most specific matching filter, or nullptr
+const TargetFilter* findTargetFilter(const MacAddr& deviceMAC) {
+    const TargetFilter* exact = findExactMACFilter(deviceMAC);
+    if (exact != nullptr) {
+        return exact;
+    }
+    
+    for (const PrefixGroup& group : prefixGroups) {
+        uint64_t key = deviceMAC.masked(group.bits).value;
+        const PrefixIndexEntry* first = prefixIndex.data() + group.begin;
+        const PrefixIndexEntry* last = prefixIndex.data() + group.end;
+        const PrefixIndexEntry* it = std::lower_bound(first, last, key,
+            [](const PrefixIndexEntry& e, uint64_t k) { return e.prefix < k; });
+        if (it != last && it->prefix == key) {
+            return &targetFilters[it->filter];
+        }
+    }
+    
+    return nullptr;
+}
+
+// Built-in vendor OUIs compiled from ouis.md, limited to enabled categories
+const BuiltinOUI* findBuiltinOUI(const MacAddr& deviceMAC) {
+    if (builtinVendorMask == 0) return nullptr;
+    
+    const BuiltinOUI* entry = lookupBuiltinOUI(deviceMAC.oui());
+    if (entry != nullptr && (builtinVendorMask & (1UL << entry->vendor))) {
+        return entry;
+    }
+    return nullptr;
+}
+
+bool hasActiveFilters() {
+    return targetFilters.size() > 0 || builtinVendorMask != 0 || identityKeys.size() > 0;
+}
+
+bool matchesTargetFilter(const MacAddr& deviceMAC, uint8_t& matchedDescription) {
+    advertsChecked++;
+    if (!prefixBloomMayContain(deviceMAC)) {
+        advertsFastRejected++;
+        return false;
+    }
+    
+    // Most specific wins: a user filter of 24 bits or more beats the
+    // built-in OUI database, a shorter user prefix does not
+    const TargetFilter* filter = findTargetFilter(deviceMAC);
+    if (filter != nullptr && filter->prefixBits >= 24) {
+        matchedDescription = filter->descriptionId;
+        return true;
+    }
+    
+    const BuiltinOUI* builtin = findBuiltinOUI(deviceMAC);
+    if (builtin != nullptr) {
+        matchedDescription = builtinDescriptionIds[builtin->vendor];
+        return true;
+    }
+    
+    if (filter != nullptr) {
+        matchedDescription = filter->descriptionId;
+        return true;
+    }
+    
+    return false;
+}
+
+// ================================
+// BLE Address Classification
+// ================================
+// Only public and random static addresses carry a stable, assignable
+// prefix. Resolvable (RPA) and non-resolvable (NRPA) private addresses
+// are random in their top bytes, so OUI/prefix matching on them is wasted
+// work and a source of false "NEW" alerts.
+enum BLEAddressClass {
+    ADDR_PUBLIC,
+    ADDR_RANDOM_STATIC,
+    ADDR_RPA,
+    ADDR_NRPA,
+    ADDR_CLASS_COUNT
+};
+
+const char* const ADDRESS_CLASS_NAMES[ADDR_CLASS_COUNT] = {"public", "static", "rpa", "nrpa"};
+
+volatile uint32_t advertsByClass[ADDR_CLASS_COUNT] = {0};
+
+BLEAddressClass classifyAddress(uint8_t addressType, const MacAddr& mac) {
+    if (addressType == BLE_ADDR_PUBLIC || addressType == BLE_ADDR_PUBLIC_ID) {
+        return ADDR_PUBLIC;
+    }
+    
+    // Random address sub-type lives in the two most significant bits
+    switch (mac.octet(0) >> 6) {
+        case 0x3: return ADDR_RANDOM_STATIC;
+        case 0x1: return ADDR_RPA;
+        default:  return ADDR_NRPA;  // 0b00, and the reserved 0b10
+    }
+}
+
+// Private addresses can still be targeted by an exact full-MAC filter
+// (e.g. one copied from a previous sighting), but never by prefix
+bool matchesRandomAddress(const MacAddr& deviceMAC, uint8_t& matchedDescription) {
+    const TargetFilter* filter = findExactMACFilter(deviceMAC);
+    if (filter == nullptr) {
+        return false;
+    }
+    matchedDescription = filter->descriptionId;
+    return true;
+}
+
+// ================================
+// RPA Resolution
+// ================================
+// A resolvable private address is prand (top 24 bits) || hash (low 24
+// bits), with hash = ah(IRK, prand). Resolving means running AES-128 once
+// per configured IRK, so results - including failures, which is what
+// nearly every stranger's phone produces - are kept in a small LRU cache
+// and repeat adverts from the same address skip the AES work entirely.
+// Each key is expanded once, when the IRKs are loaded or saved, so a
+// cache miss costs one block encryption per IRK and nothing more.
+// mbedtls routes the block cipher to the ESP32 AES peripheral.
+#define RPA_CACHE_SIZE 64
+#define RPA_UNRESOLVED 0xFF
+
+struct RPACacheEntry {
+    uint64_t address;    // 0 when unused (never a valid RPA)
+    uint32_t lastUsed;
+    uint8_t identity;    // index into identityKeys, or RPA_UNRESOLVED
+};
+
+RPACacheEntry rpaCache[RPA_CACHE_SIZE];
+uint32_t rpaCacheClock = 0;
+mbedtls_aes_context* rpaKeys = nullptr;  // one expanded key per identityKeys entry
+size_t rpaKeyCount = 0;
+
+volatile uint32_t rpaResolved = 0;
+volatile uint32_t rpaCacheHits = 0;
+
+// Stable stand-in for the identity address, shaped like a random static
+// address so it never collides with a public OUI. It is shown in device
+// listings and stored in the journal, so it is derived one-way - AES-128
+// of a fixed block under the IRK - and reveals nothing about the key.
+MacAddr identityForIRK(const uint8_t irk[16]) {
+    static const uint8_t label[16] = {'O', 'U', 'I', '-', 'S', 'p', 'y', ' ', 'i', 'd', 'e', 'n', 't', 'i', 't', 'y'};
+    uint8_t out[16];
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, irk, 128);
+    mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, label, out);
+    mbedtls_aes_free(&aes);
+    return MacAddr(MacAddr::fromBytes(out).value | 0xC00000000000ULL);
+}
+
+bool parseIRK(const String& text, uint8_t irk[16]) {
+    String hex = text;
+    hex.replace(":", "");
+    hex.replace("-", "");
+    if (hex.startsWith("0x") || hex.startsWith("0X")) hex = hex.substring(2);
+    if (hex.length() != 32) return false;
+    
+    for (int i = 0; i < 16; i++) {
+        int hi = MacAddr::hexValue(hex.charAt(2 * i));
+        int lo = MacAddr::hexValue(hex.charAt(2 * i + 1));
+        if (hi < 0 || lo < 0) return false;
+        irk[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+String formatIRK(const uint8_t irk[16]) {
+    char buf[33];
+    for (int i = 0; i < 16; i++) {
+        snprintf(buf + 2 * i, 3, "%02x", irk[i]);
+    }
+    return String(buf);
+}
+
+// Call whenever identityKeys changes: interns the descriptions, expands the keys
+// and drops cached results
+void resetRPACache() {
+    memset(rpaCache, 0, sizeof(rpaCache));
+    rpaCacheClock = 0;
+    for (IdentityKey& key : identityKeys) {
+        key.descriptionId = internDescription("IRK: " + key.name);
+    }
+    
+    for (size_t i = 0; i < rpaKeyCount; i++) {
+        mbedtls_aes_free(&rpaKeys[i]);
+    }
+    delete[] rpaKeys;
+    rpaKeys = nullptr;
+    rpaKeyCount = 0;
+    if (identityKeys.empty()) return;
+    
+    rpaKeys = new (std::nothrow) mbedtls_aes_context[identityKeys.size()];
+    if (rpaKeys == nullptr) return;
+    rpaKeyCount = identityKeys.size();
+    for (size_t i = 0; i < rpaKeyCount; i++) {
+        mbedtls_aes_init(&rpaKeys[i]);
+        mbedtls_aes_setkey_enc(&rpaKeys[i], identityKeys[i].irk, 128);
+    }
+}
+
+// Bluetooth Core Vol 3, Part H, 2.2.2: ah(k, r) = e(k, padding || r) mod 2^24
+bool rpaMatchesIRK(mbedtls_aes_context& key, const MacAddr& rpa) {
+    uint8_t block[16] = {0};
+    block[13] = rpa.octet(0);
+    block[14] = rpa.octet(1);
+    block[15] = rpa.octet(2);
+    
+    uint8_t out[16];
+    mbedtls_aes_crypt_ecb(&key, MBEDTLS_AES_ENCRYPT, block, out);
+    
+    uint32_t hash = ((uint32_t)out[13] << 16) | ((uint32_t)out[14] << 8) | out[15];
+    return hash == (uint32_t)(rpa.value & 0xFFFFFF);
+}
+
+// Returns the identityKeys entry owning this RPA, or nullptr
+const IdentityKey* resolveRPA(const MacAddr& rpa) {
+    if (identityKeys.empty()) return nullptr;
+    
+    rpaCacheClock++;
+    RPACacheEntry* victim = &rpaCache[0];
+    for (int i = 0; i < RPA_CACHE_SIZE; i++) {
+        RPACacheEntry& entry = rpaCache[i];
+        if (entry.address == rpa.value) {
+            entry.lastUsed = rpaCacheClock;
+            rpaCacheHits++;
+            return entry.identity == RPA_UNRESOLVED ? nullptr : &identityKeys[entry.identity];
+        }
+        if (entry.lastUsed < victim->lastUsed) victim = &entry;
+    }
+    
+    uint8_t identity = RPA_UNRESOLVED;
+    for (size_t i = 0; i < rpaKeyCount && i < RPA_UNRESOLVED; i++) {
+        if (rpaMatchesIRK(rpaKeys[i], rpa)) {
+            identity = (uint8_t)i;
+            rpaResolved++;
+            break;
+        }
+    }
+    
+    // Evict the least recently used entry (unused entries have lastUsed 0)
+    victim->address = rpa.value;
+    victim->lastUsed = rpaCacheClock;
+    victim->identity = identity;
+    
+    return identity == RPA_UNRESOLVED ? nullptr : &identityKeys[identity];
+}
+
+// ================================
+// Advertisement Payload Matching
+// ================================
+// Trackers and body cams often rotate private addresses, so they are
+// matched on what they advertise instead. The raw payload (advert plus
+// scan response) is walked in place with AdIterator (ad_parser.h).
+
+// p points at a 128-bit UUID in over-the-air (little-endian) order
+const TargetFilter* findUUID128Filter(const uint8_t* p) {
+    UUID128 uuid = {readLE64(p + 8), readLE64(p)};
+    uint16_t uuid16;
+    if (isBluetoothBaseUUID(uuid, uuid16)) {
+        return findPayloadFilter(FILTER_UUID16, uuid16);
+    }
+    return findPayloadFilter(FILTER_UUID128, uuid.high, uuid.low);
+}
+
+const TargetFilter* findNameFilter(const uint8_t* name, uint8_t length) {
+    for (const NameIndexEntry& entry : nameIndex) {
+        if (entry.length <= length && memcmp(name, entry.prefix, entry.length) == 0) {
+            return &targetFilters[entry.filter];
+        }
+    }
+    return nullptr;
+}
+
+bool matchesPayloadFilter(const uint8_t* payload, size_t length, uint8_t& matchedDescription) {
+    const TargetFilter* match = nullptr;
+    AdIterator it(payload, length);
+    AdField field;
+    
+    while (match == nullptr && it.next(field)) {
+        const AdSpan& value = field.value;
+        
+        switch (field.type) {
+            case AD_TYPE_UUID16_INCOMPLETE:
+            case AD_TYPE_UUID16_COMPLETE:
+                for (uint8_t i = 0; i + 2 <= value.length && match == nullptr; i += 2) {
+                    match = findPayloadFilter(FILTER_UUID16, readLE16(value.data + i));
+                }
+                break;
+            case AD_TYPE_UUID128_INCOMPLETE:
+            case AD_TYPE_UUID128_COMPLETE:
+                for (uint8_t i = 0; i + 16 <= value.length && match == nullptr; i += 16) {
+                    match = findUUID128Filter(value.data + i);
+                }
+                break;
+            case AD_TYPE_SERVICE_DATA16:
+                if (value.length >= 2) match = findPayloadFilter(FILTER_UUID16, readLE16(value.data));
+                break;
+            case AD_TYPE_SERVICE_DATA128:
+                if (value.length >= 16) match = findUUID128Filter(value.data);
+                break;
+            case AD_TYPE_MANUFACTURER_DATA:
+                if (value.length >= 2) match = findPayloadFilter(FILTER_COMPANY_ID, readLE16(value.data));
+                break;
+            case AD_TYPE_NAME_SHORT:
+            case AD_TYPE_NAME_COMPLETE:
+                match = findNameFilter(value.data, value.length);
+                break;
+        }
+    }
+    
+    if (match == nullptr) {
+        return false;
+    }
+    matchedDescription = match->descriptionId;
+    return true;
+}
+
+// ================================
+// Configuration Storage Functions
+// ================================
+// Filters are stored as one versioned blob under the "filters" key: a
+// fixed-size binary record per filter, then a string table holding each
+// distinct pattern and description once. Loading is one getBytes() and
+// goes straight into targetFilters with no text parsing, so thousands of
+// filters load quickly and cost one NVS entry instead of three each.
+#define FILTER_BLOB_KEY "filters"
+#define FILTER_BLOB_MAGIC 0x4C46534F   // "OSFL"
+#define FILTER_BLOB_VERSION 1
+#define FILTER_RECORD_BYTES 18         // kind 1, prefixBits 1, payloadId 2, identifier 6, pattern 4, description 4
+#define FILTER_NO_STRING 0xFFFFFFFFUL
+
+// Appends text to the string table (u16 length, then the bytes) unless
+// an identical string is already there; returns its offset
+uint32_t addFilterString(std::vector<uint8_t>& table, std::map<String, uint32_t>& offsets, const String& text) {
+    if (text.length() == 0) return FILTER_NO_STRING;
+    std::map<String, uint32_t>::const_iterator it = offsets.find(text);
+    if (it != offsets.end()) return it->second;
+    
+    uint32_t offset = table.size();
+    size_t length = text.length() < 0xFFFF ? text.length() : 0xFFFF;
+    table.push_back((uint8_t)length);
+    table.push_back((uint8_t)(length >> 8));
+    table.insert(table.end(), text.c_str(), text.c_str() + length);
+    offsets[text] = offset;
+    return offset;
+}
+
+void writeFilterBlob(NvsBlobWriter& blob) {
+    std::vector<uint8_t> strings;
+    std::map<String, uint32_t> offsets;
+    blob.reserve(targetFilters.size() * FILTER_RECORD_BYTES);
+    
+    for (const TargetFilter& filter : targetFilters) {
+        blob.put8(filter.kind);
+        blob.put8(filter.prefixBits);
+        blob.put16(filter.payloadId);
+        blob.put48(filter.identifier.value);
+        blob.put32(addFilterString(strings, offsets, filter.pattern));
+        blob.put32(addFilterString(strings, offsets, filter.description));
+    }
+    blob.putBytes(strings.data(), strings.size());
+}
+
+// Reads the string at offset in the table starting at tableStart, leaving
+// the reader where it was
+String readFilterString(NvsBlobReader& blob, size_t tableStart, uint32_t offset) {
+    if (offset == FILTER_NO_STRING) return String();
+    size_t resume = blob.tell();
+    blob.seek(tableStart + offset);
+    uint16_t length;
+    const char* text = blob.getString(length);
+    blob.seek(resume);
+    return String(text, length);
+}
+
+bool readFilterBlob(const uint8_t* data, size_t length, std::vector<TargetFilter>& filters) {
+    NvsBlobReader blob;
+    if (!blob.open(data, length, FILTER_BLOB_MAGIC, FILTER_BLOB_VERSION)) return false;
+    
+    if (blob.count() > MAX_TARGET_FILTERS) return false;
+    size_t tableStart = (size_t)blob.count() * FILTER_RECORD_BYTES;
+    if (tableStart > blob.payloadSize()) return false;
+    
+    filters.clear();
+    filters.reserve(blob.count());
+    for (uint32_t i = 0; i < blob.count(); i++) {
+        TargetFilter filter;
+        filter.kind = (FilterKind)blob.get8();
+        filter.prefixBits = blob.get8();
+        filter.payloadId = blob.get16();
+        filter.identifier = MacAddr(blob.get48());
+        filter.pattern = readFilterString(blob, tableStart, blob.get32());
+        filter.description = readFilterString(blob, tableStart, blob.get32());
+        if (blob.failed()) return false;
+        if (filter.kind > FILTER_NAME_PREFIX || (filter.isMAC() && (filter.prefixBits < 1 || filter.prefixBits > 48))) continue;
+        filters.push_back(filter);
+    }
+    return true;
+}
+
+// Removes the per-filter keys written by older firmware
+void removeLegacyFilterKeys() {
+    if (!preferences.isKey("filterCount")) return;
+    int legacyCount = preferences.getInt("filterCount", 0);
+    for (int i = 0; i < legacyCount; i++) {
+        preferences.remove(("id_" + String(i)).c_str());
+        preferences.remove(("mac_" + String(i)).c_str());
+        preferences.remove(("desc_" + String(i)).c_str());
+    }
+    preferences.remove("filterCount");
+}
+
+void saveConfiguration() {
+    NvsBlobWriter blob(FILTER_BLOB_MAGIC, FILTER_BLOB_VERSION);
+    writeFilterBlob(blob);
+    const std::vector<uint8_t>& bytes = blob.finish(targetFilters.size(), 0);
+    
+    preferences.begin("ouispy", false);
+    // Old keys go only once the blob is safely written
+    bool filtersSaved = preferences.putBytes(FILTER_BLOB_KEY, bytes.data(), bytes.size()) == bytes.size();
+    if (filtersSaved) {
+        removeLegacyFilterKeys();
+    }
+    preferences.putBool("buzzerEnabled", buzzerEnabled);
+    preferences.putBool("ledEnabled", ledEnabled);
+    preferences.putUInt("builtinVendors", builtinVendorMask);
+    preferences.putUInt("deviceLimit", deviceTableLimit);
+    
+    int previousIrkCount = preferences.getInt("irkCount", 0);
+    preferences.putInt("irkCount", identityKeys.size());
+    for (size_t i = 0; i < identityKeys.size(); i++) {
+        String keyIRK = "irk_" + String(i);
+        String keyName = "irk_name_" + String(i);
+        
+        preferences.putBytes(keyIRK.c_str(), identityKeys[i].irk, sizeof(identityKeys[i].irk));
+        preferences.putString(keyName.c_str(), identityKeys[i].name);
+    }
+    // Drop the keys of IRKs that were removed since the last save
+    for (int i = (int)identityKeys.size(); i < previousIrkCount; i++) {
+        preferences.remove(("irk_" + String(i)).c_str());
+        preferences.remove(("irk_name_" + String(i)).c_str());
+    }
+    
+    preferences.end();
+    
+    if (isSerialConnected()) {
+        if (filtersSaved) {
+            Serial.println("Configuration saved to NVS (" + String(bytes.size()) + " byte filter blob)");
+        } else {
+            Serial.println("ERROR: filter blob (" + String(bytes.size()) + " bytes) does not fit in NVS");
+        }
+    }
+}
+
+// Older firmware stored three keys per filter; read once so filters
+// survive the upgrade. The next save replaces them with the blob.
+void loadLegacyFilters() {
+    int filterCount = preferences.getInt("filterCount", 0);
+    for (int i = 0; i < filterCount && targetFilters.size() < MAX_TARGET_FILTERS; i++) {
+        String keyId = "id_" + String(i);
+        String keyDesc = "desc_" + String(i);
+        
+        TargetFilter filter;
+        String identifier = preferences.getString(keyId.c_str(), "");
+        
+        if (parseFilterSpec(identifier, filter)) {
+            filter.description = preferences.getString(keyDesc.c_str(), "");
+            targetFilters.push_back(filter);
+        }
+    }
+}
+
+void loadConfiguration() {
+    unsigned long startTime = micros();
+    preferences.begin("ouispy", true);
+    buzzerEnabled = preferences.getBool("buzzerEnabled", true);
+    ledEnabled = preferences.getBool("ledEnabled", true);
+    builtinVendorMask = preferences.getUInt("builtinVendors", 0);
+    setDeviceTableLimit(preferences.getUInt("deviceLimit", DEVICE_TABLE_CAPACITY));
+    
+    targetFilters.clear();
+    
+    size_t blobLength = preferences.getBytesLength(FILTER_BLOB_KEY);
+    if (blobLength > 0) {
+        std::vector<uint8_t> data(blobLength);
+        preferences.getBytes(FILTER_BLOB_KEY, data.data(), blobLength);
+        if (!readFilterBlob(data.data(), blobLength, targetFilters)) {
+            targetFilters.clear();
+            Serial.println("Filter blob in NVS is invalid - using defaults");
+        }
+    } else {
+        loadLegacyFilters();
+    }
+    
+    // Load saved filters or use defaults
+    if (targetFilters.empty()) {
+        // Default configuration
+        targetFilters.push_back(makeMACFilter(MacAddr(0xAABBCC000000ULL), 24, "Example Manufacturer"));
+        targetFilters.push_back(makeMACFilter(MacAddr(0xDDEEFF000000ULL), 24, "Another Manufacturer"));
+        targetFilters.push_back(makeMACFilter(MacAddr(0xAABBCC123456ULL), 48, "Specific Device"));
+    }
+    
+    identityKeys.clear();
+    int irkCount = preferences.getInt("irkCount", 0);
+    for (int i = 0; i < irkCount; i++) {
+        String keyIRK = "irk_" + String(i);
+        String keyName = "irk_name_" + String(i);
+        
+        IdentityKey key;
+        if (preferences.getBytes(keyIRK.c_str(), key.irk, sizeof(key.irk)) == sizeof(key.irk)) {
+            key.identity = identityForIRK(key.irk);
+            key.name = preferences.getString(keyName.c_str(), "");
+            identityKeys.push_back(key);
+        }
+    }
+    resetRPACache();
+    
+    preferences.end();
+    
+    rebuildFilterIndex();
+    
+    Serial.println("Configuration loaded: " + String(targetFilters.size()) + " filters (" +
+                   String(blobLength) + " byte blob) in " + String((micros() - startTime) / 1000.0, 2) + " ms");
+}
+
+void loadWiFiCredentials() {
+    preferences.begin("ouispy", true);
+    AP_SSID = preferences.getString("ap_ssid", "snoopuntothem");
+    AP_PASSWORD = preferences.getString("ap_password", "astheysnoopuntous");
+    preferences.end();
+}
+
+void saveWiFiCredentials() {
+    preferences.begin("ouispy", false);
+    preferences.putString("ap_ssid", AP_SSID);
+    preferences.putString("ap_password", AP_PASSWORD);
+    preferences.end();
+}
+
+// ================================
+// Device Alias Functions
+// ================================
+// Stored as one versioned blob under the "aliases" key: the sorted
+// entries (MAC, name offset), then the name pool, compacted on save.
+#define ALIAS_BLOB_KEY "aliases"
+#define ALIAS_BLOB_MAGIC 0x4C41534F   // "OSAL"
+#define ALIAS_BLOB_VERSION 1
+#define ALIAS_RECORD_BYTES 10         // mac 6, name offset 4
+
+// First entry whose MAC is not below mac
+std::vector<AliasEntry>::iterator findAliasEntry(uint64_t mac) {
+    return std::lower_bound(deviceAliases.begin(), deviceAliases.end(), mac,
+        [](const AliasEntry& e, uint64_t k) { return e.mac < k; });
+}
+
+uint32_t addAliasName(const String& alias) {
+    uint32_t offset = aliasNames.size();
+    aliasNames.insert(aliasNames.end(), alias.c_str(), alias.c_str() + alias.length() + 1);
+    return offset;
+}
+
+// Rewrites the pool with only the names still in use
+void compactAliasNames() {
+    std::vector<char> pool;
+    pool.reserve(aliasNames.size() - aliasNamesGarbage);
+    for (AliasEntry& entry : deviceAliases) {
+        const char* name = &aliasNames[entry.nameOffset];
+        uint32_t offset = pool.size();
+        pool.insert(pool.end(), name, name + strlen(name) + 1);
+        entry.nameOffset = offset;
+    }
+    aliasNames.swap(pool);
+    aliasNamesGarbage = 0;
+}
+
+void clearDeviceAliases() {
+    deviceAliases.clear();
+    aliasNames.clear();
+    aliasNamesGarbage = 0;
+}
+
+// Removes the per-alias keys written by older firmware
+void removeLegacyAliasKeys() {
+    if (!preferences.isKey("aliasCount")) return;
+    int legacyCount = preferences.getInt("aliasCount", 0);
+    for (int i = 0; i < legacyCount; i++) {
+        preferences.remove(("alias_mac_" + String(i)).c_str());
+        preferences.remove(("alias_name_" + String(i)).c_str());
+    }
+    preferences.remove("aliasCount");
+}
+
+void saveDeviceAliases() {
+    compactAliasNames();
+    
+    NvsBlobWriter blob(ALIAS_BLOB_MAGIC, ALIAS_BLOB_VERSION);
+    blob.reserve(deviceAliases.size() * ALIAS_RECORD_BYTES + aliasNames.size());
+    for (const AliasEntry& entry : deviceAliases) {
+        blob.put48(entry.mac);
+        blob.put32(entry.nameOffset);
+    }
+    blob.putBytes(aliasNames.data(), aliasNames.size());
+    const std::vector<uint8_t>& bytes = blob.finish(deviceAliases.size(), 0);
+    
+    preferences.begin("ouispy", false);
+    bool saved = preferences.putBytes(ALIAS_BLOB_KEY, bytes.data(), bytes.size()) == bytes.size();
+    if (saved) {
+        removeLegacyAliasKeys();
+    }
+    preferences.end();
+    
+    if (isSerialConnected()) {
+        if (saved) {
+            Serial.println("Device aliases saved to NVS (" + String(deviceAliases.size()) + " aliases)");
+        } else {
+            Serial.println("ERROR: alias blob (" + String(bytes.size()) + " bytes) does not fit in NVS");
+        }
+    }
+}
+
+bool readAliasBlob(const uint8_t* data, size_t length) {
+    NvsBlobReader blob;
+    if (!blob.open(data, length, ALIAS_BLOB_MAGIC, ALIAS_BLOB_VERSION)) return false;
+    
+    size_t poolStart = (size_t)blob.count() * ALIAS_RECORD_BYTES;
+    if (poolStart > blob.payloadSize()) return false;
+    size_t poolBytes = blob.payloadSize() - poolStart;
+    // Every name must be terminated inside the pool
+    if (poolBytes > 0 && blob.payload()[blob.payloadSize() - 1] != '\0') return false;
+    
+    deviceAliases.resize(blob.count());
+    for (AliasEntry& entry : deviceAliases) {
+        entry.mac = blob.get48();
+        entry.nameOffset = blob.get32();
+        if (entry.nameOffset >= poolBytes) return false;
+    }
+    aliasNames.assign(blob.payload() + poolStart, blob.payload() + blob.payloadSize());
+    
+    // Saved sorted and unique, but never trust that for a binary search:
+    // order by MAC, keeping record order among duplicates, and let the
+    // last record written for a MAC win
+    std::stable_sort(deviceAliases.begin(), deviceAliases.end(),
+        [](const AliasEntry& a, const AliasEntry& b) { return a.mac < b.mac; });
+    size_t kept = 0;
+    for (size_t i = 0; i < deviceAliases.size(); i++) {
+        if (i + 1 < deviceAliases.size() && deviceAliases[i + 1].mac == deviceAliases[i].mac) continue;
+        deviceAliases[kept++] = deviceAliases[i];
+    }
+    deviceAliases.resize(kept);
+    return true;
+}
+
+void setDeviceAlias(const MacAddr& macAddress, const String& alias);
+
+// Older firmware stored two text keys per alias; read once so aliases
+// survive the upgrade. The next save replaces them with the blob.
+void loadLegacyDeviceAliases() {
+    int aliasCount = preferences.getInt("aliasCount", 0);
+    for (int i = 0; i < aliasCount; i++) {
+        String mac = preferences.getString(("alias_mac_" + String(i)).c_str(), "");
+        String alias = preferences.getString(("alias_name_" + String(i)).c_str(), "");
+        
+        MacAddr parsedMAC;
+        if (MacAddr::parse(mac.c_str(), parsedMAC) == 6 && alias.length() > 0) {
+            setDeviceAlias(parsedMAC, alias);
+        }
+    }
+}
+
+void loadDeviceAliases() {
+    preferences.begin("ouispy", true);
+    clearDeviceAliases();
+    
+    size_t length = preferences.getBytesLength(ALIAS_BLOB_KEY);
+    if (length > 0) {
+        std::vector<uint8_t> data(length);
+        preferences.getBytes(ALIAS_BLOB_KEY, data.data(), length);
+        if (!readAliasBlob(data.data(), length)) {
+            clearDeviceAliases();
+            Serial.println("Alias blob in NVS is invalid - ignored");
+        }
+    } else {
+        loadLegacyDeviceAliases();
+    }
+    
+    preferences.end();
+    
+    if (isSerialConnected()) {
+        Serial.println("Device aliases loaded from NVS (" + String(deviceAliases.size()) + " aliases)");
+    }
+}
+
+// Returns the alias, or "" if the device has none. The pointer is valid
+// until the aliases next change.
+const char* getDeviceAlias(const MacAddr& macAddress) {
+    std::vector<AliasEntry>::iterator it = findAliasEntry(macAddress.value);
+    if (it != deviceAliases.end() && it->mac == macAddress.value) {
+        return &aliasNames[it->nameOffset];
+    }
+    
+    return ""; // No alias found
+}
+
+// An empty alias removes the device's entry
+void setDeviceAlias(const MacAddr& macAddress, const String& alias) {
+    std::vector<AliasEntry>::iterator it = findAliasEntry(macAddress.value);
+    bool exists = it != deviceAliases.end() && it->mac == macAddress.value;
+    
+    if (exists) {
+        aliasNamesGarbage += strlen(&aliasNames[it->nameOffset]) + 1;
+        if (alias.length() > 0) {
+            it->nameOffset = addAliasName(alias);
+        } else {
+            deviceAliases.erase(it);
+        }
+    } else if (alias.length() > 0) {
+        AliasEntry entry;
+        entry.mac = macAddress.value;
+        entry.nameOffset = addAliasName(alias);
+        deviceAliases.insert(it, entry);
+    }
+    
+    if (aliasNamesGarbage > aliasNames.size() / 2) {
+        compactAliasNames();
+    }
+}
+
+// ================================
+// Tracked Device Table
+// ================================
+// Every matched device, keyed by MAC. Records live in one preallocated
+// pool (PSRAM on boards that have it) and are found through an
+// open-addressing index of pool positions, so lookup and insert are O(1)
+// and nothing allocates in the scan callback however long the device runs.
+//
+// The pool is stored column-wise: one array per field, all indexed by
+// pool position, 30 bytes per device plus 4 for the index. Sweeps that
+// read one field (timestamps, RSSI) stream through a single array, and
+// the match description is an index into an interned string table
+// instead of a String per device.
+//
+// Records are also threaded on a doubly linked recency list. Every
+// sighting moves the device to the front; once deviceTableLimit devices
+// are tracked, a new one takes over the least recently seen record.
+// Walk it with:
+//   for (uint16_t i = deviceLRUHead; i != EMPTY_DEVICE_SLOT; i = devices.lruNext[i])
+//
+// The BLE callback updates the table on the NimBLE task. Anything else
+// that walks or changes it once scanning has started - snapshots, the
+// journal, the web API - holds deviceTableLock, and only for as long as
+// it takes to copy out what it needs.
+
+#if DEVICE_TABLE_CAPACITY >= 0xFFFF
+#error "DEVICE_TABLE_CAPACITY must fit a 16-bit pool position"
+#endif
+#if 3 * DEVICE_INDEX_SLOTS < 4 * DEVICE_TABLE_CAPACITY || (DEVICE_INDEX_SLOTS & (DEVICE_INDEX_SLOTS - 1)) != 0
+#error "DEVICE_INDEX_SLOTS must be a power of two at least 4/3 of DEVICE_TABLE_CAPACITY"
+#endif
+
+#define DEVICE_PERSIST_LIMIT 100  // most recent devices kept across restarts
+#define DEVICE_RECORD_BYTES 30     // sum of the DeviceColumns element sizes
+#define DEVICE_LOCK_WAIT_MS 5  // longest the BLE callback waits for deviceTableLock
+
+const uint16_t EMPTY_DEVICE_SLOT = 0xFFFF;
+
+struct DeviceColumns {
+    uint64_t* mac;          // MacAddr::value
+    uint32_t* lastSeen;     // millis(); compare by subtraction so wrap is harmless
+    uint32_t* firstSeen;
+    uint16_t* cooldownMs;   // alerts suppressed until lastSeen + cooldownMs, 0 = none
+    int8_t* rssi;           // dBm, last raw sample
+    int16_t* rssiLevel;     // filtered RSSI, Q4 dBm
+    int16_t* rssiRate;      // filtered RSSI slope, Q4 dB per second
+    uint16_t* lastSampleMs; // low 16 bits of millis() at the last RSSI sample
+    uint8_t* description;   // index into deviceDescriptions, or NO_DESCRIPTION
+    uint16_t* lruPrev;      // pool positions, EMPTY_DEVICE_SLOT at the ends
+    uint16_t* lruNext;      // also chains the free list
+};
+
+DeviceColumns devices;
+uint16_t* deviceIndex = nullptr;    // DEVICE_INDEX_SLOTS pool positions
+size_t deviceCount = 0;
+uint16_t deviceLRUHead = EMPTY_DEVICE_SLOT;  // most recently seen
+uint16_t deviceLRUTail = EMPTY_DEVICE_SLOT;  // next to be evicted
+uint16_t deviceFreeList = EMPTY_DEVICE_SLOT; // unused records, chained on lruNext
+volatile uint32_t devicesEvicted = 0;
+// Sightings the BLE callback gave up on because deviceTableLock was held
+// longer than DEVICE_LOCK_WAIT_MS; the device is seen again next advert
+volatile uint32_t sightingsDropped = 0;
+// Bumped when devices are added, evicted or cleared - changes the NVS
+// snapshot is rewritten for as soon as they happen
+volatile uint32_t deviceTableGeneration = 0;
+// Bumped by every published detection, which only moves lastSeen and RSSI
+volatile uint32_t deviceSightings = 0;
+SemaphoreHandle_t deviceTableLock = nullptr;  // guards devices, deviceIndex and deviceDescriptions
+
+void* allocateDeviceStorage(size_t bytes) {
+    void* ptr = nullptr;
+#ifdef BOARD_HAS_PSRAM
+    if (psramFound()) {
+        ptr = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+#endif
+    if (ptr == nullptr) {
+        ptr = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+void resetDeviceRecord(uint16_t pos) {
+    devices.mac[pos] = 0;
+    devices.lastSeen[pos] = 0;
+    devices.firstSeen[pos] = 0;
+    devices.cooldownMs[pos] = 0;
+    devices.rssi[pos] = 0;
+    devices.rssiLevel[pos] = 0;
+    devices.rssiRate[pos] = 0;
+    devices.lastSampleMs[pos] = 0;
+    devices.description[pos] = NO_DESCRIPTION;
+    devices.lruPrev[pos] = EMPTY_DEVICE_SLOT;
+    devices.lruNext[pos] = EMPTY_DEVICE_SLOT;
+}
+
+void clearDeviceTable() {
+    for (size_t i = 0; i < DEVICE_TABLE_CAPACITY; i++) {
+        resetDeviceRecord(i);
+        devices.lruNext[i] = (i + 1 < DEVICE_TABLE_CAPACITY) ? (uint16_t)(i + 1) : EMPTY_DEVICE_SLOT;
+    }
+    memset(deviceIndex, 0xFF, DEVICE_INDEX_SLOTS * sizeof(uint16_t));
+    deviceCount = 0;
+    deviceLRUHead = EMPTY_DEVICE_SLOT;
+    deviceLRUTail = EMPTY_DEVICE_SLOT;
+    deviceFreeList = 0;
+    deviceTableGeneration++;
+}
+
+// Called once from setup(), before anything touches the table
+void initDeviceTable() {
+    // Widest columns first keeps every array naturally aligned
+    const size_t n = DEVICE_TABLE_CAPACITY;
+    uint8_t* pool = (uint8_t*)allocateDeviceStorage(n * DEVICE_RECORD_BYTES);
+    devices.mac = (uint64_t*)pool;              pool += n * sizeof(uint64_t);
+    devices.lastSeen = (uint32_t*)pool;         pool += n * sizeof(uint32_t);
+    devices.firstSeen = (uint32_t*)pool;        pool += n * sizeof(uint32_t);
+    devices.cooldownMs = (uint16_t*)pool;       pool += n * sizeof(uint16_t);
+    devices.rssiLevel = (int16_t*)pool;         pool += n * sizeof(int16_t);
+    devices.rssiRate = (int16_t*)pool;          pool += n * sizeof(int16_t);
+    devices.lastSampleMs = (uint16_t*)pool;     pool += n * sizeof(uint16_t);
+    devices.lruPrev = (uint16_t*)pool;          pool += n * sizeof(uint16_t);
+    devices.lruNext = (uint16_t*)pool;          pool += n * sizeof(uint16_t);
+    devices.rssi = (int8_t*)pool;               pool += n * sizeof(int8_t);
+    devices.description = pool;
+    
+    deviceIndex = (uint16_t*)allocateDeviceStorage(DEVICE_INDEX_SLOTS * sizeof(uint16_t));
+    deviceDescriptions.reserve(DESCRIPTION_TABLE_SIZE);
+    deviceTableLock = xSemaphoreCreateMutex();
+    clearDeviceTable();
+}
+
+float deviceTableLoadFactor() {
+    return (float)deviceCount / DEVICE_INDEX_SLOTS;
+}
+
+void unlinkDevice(uint16_t pos) {
+    uint16_t prev = devices.lruPrev[pos];
+    uint16_t next = devices.lruNext[pos];
+    if (prev != EMPTY_DEVICE_SLOT) devices.lruNext[prev] = next;
+    else deviceLRUHead = next;
+    if (next != EMPTY_DEVICE_SLOT) devices.lruPrev[next] = prev;
+    else deviceLRUTail = prev;
+}
+
+void linkDeviceAtFront(uint16_t pos) {
+    devices.lruPrev[pos] = EMPTY_DEVICE_SLOT;
+    devices.lruNext[pos] = deviceLRUHead;
+    if (deviceLRUHead != EMPTY_DEVICE_SLOT) devices.lruPrev[deviceLRUHead] = pos;
+    else deviceLRUTail = pos;
+    deviceLRUHead = pos;
+}
+
+// Index slot holding this MAC, or the empty slot where it would go
+uint32_t findDeviceSlot(const MacAddr& mac) {
+    uint32_t slot = hashMAC(mac.value) & (DEVICE_INDEX_SLOTS - 1);
+    while (deviceIndex[slot] != EMPTY_DEVICE_SLOT && devices.mac[deviceIndex[slot]] != mac.value) {
+        slot = (slot + 1) & (DEVICE_INDEX_SLOTS - 1);
+    }
+    return slot;
+}
+
+// Backward-shift deletion keeps linear probe chains intact without tombstones
+void removeDeviceSlot(uint32_t slot) {
+    uint32_t next = slot;
+    while (true) {
+        next = (next + 1) & (DEVICE_INDEX_SLOTS - 1);
+        if (deviceIndex[next] == EMPTY_DEVICE_SLOT) break;
+        
+        uint32_t home = hashMAC(devices.mac[deviceIndex[next]]) & (DEVICE_INDEX_SLOTS - 1);
+        // Move the entry back unless its home lies cyclically in (slot, next]
+        bool stays = (slot < next) ? (home > slot && home <= next) : (home > slot || home <= next);
+        if (!stays) {
+            deviceIndex[slot] = deviceIndex[next];
+            slot = next;
+        }
+    }
+    deviceIndex[slot] = EMPTY_DEVICE_SLOT;
+}
+
+// Drops the least recently seen device and returns its record to the free list
+void evictOldestDevice() {
+    uint16_t pos = deviceLRUTail;
+    if (pos == EMPTY_DEVICE_SLOT) return;
+    
+    removeDeviceSlot(findDeviceSlot(MacAddr(devices.mac[pos])));
+    unlinkDevice(pos);
+    resetDeviceRecord(pos);
+    devices.lruNext[pos] = deviceFreeList;
+    deviceFreeList = pos;
+    deviceCount--;
+    devicesEvicted++;
+    deviceTableGeneration++;
+}
+
+// Clamped to the compiled capacity; shrinking evicts the oldest devices
+void setDeviceTableLimit(size_t limit) {
+    if (limit < 1) limit = 1;
+    if (limit > DEVICE_TABLE_CAPACITY) limit = DEVICE_TABLE_CAPACITY;
+    deviceTableLimit = limit;
+    while (deviceCount > deviceTableLimit) {
+        evictOldestDevice();
+    }
+}
+
+// Returns the device's pool position and marks it most recently seen,
+// or EMPTY_DEVICE_SLOT if it is not tracked
+uint16_t findDevice(const MacAddr& mac) {
+    uint16_t pos = deviceIndex[findDeviceSlot(mac)];
+    if (pos == EMPTY_DEVICE_SLOT) return EMPTY_DEVICE_SLOT;
+    
+    if (pos != deviceLRUHead) {
+        unlinkDevice(pos);
+        linkDeviceAtFront(pos);
+    }
+    return pos;
+}
+
+// Returns the existing record for this MAC, or a fresh one with only the
+// MAC set, evicting the least recently seen device if at the limit.
+// Either way the device becomes the most recently seen.
+uint16_t insertDevice(const MacAddr& mac) {
+    uint16_t existing = findDevice(mac);
+    if (existing != EMPTY_DEVICE_SLOT) return existing;
+    
+    if (deviceCount >= deviceTableLimit) {
+        evictOldestDevice();
+    }
+    
+    uint16_t pos = deviceFreeList;
+    deviceFreeList = devices.lruNext[pos];
+    
+    resetDeviceRecord(pos);
+    devices.mac[pos] = mac.value;
+    // Eviction may have shifted index entries, so probe again
+    deviceIndex[findDeviceSlot(mac)] = pos;
+    linkDeviceAtFront(pos);
+    deviceCount++;
+    deviceTableGeneration++;
+    return pos;
+}
+
+// ================================
+// Per-Device RSSI Trend
+// ================================
+// Each sighting feeds a fixed-point alpha-beta filter (a steady-state 1-D
+// Kalman filter tracking level and rate): predict the level from the
+// current rate, then nudge level and rate toward the new sample. O(1),
+// integer-only and safe in the scan callback. The rate classifies the
+// device as approaching (getting louder), steady or receding.
+#define RSSI_ALPHA_SHIFT 2             // level gain 1/4
+#define RSSI_BETA_SHIFT 6              // rate gain 1/64
+#define RSSI_MIN_DT_MS 50              // adverts closer than this update the level only
+#define RSSI_RESET_MS 60000            // longer gaps restart the filter (and keep dt in 16 bits)
+#define RSSI_MAX_RATE_Q4 (20 * 16)     // 20 dB/s
+#define RSSI_TREND_THRESHOLD_Q4 16     // 1 dB/s
+
+enum RSSITrend : uint8_t {
+    TREND_STEADY,
+    TREND_APPROACHING,
+    TREND_RECEDING
+};
+
+const char* const RSSI_TREND_NAMES[] = {"steady", "approaching", "receding"};
+
+// Call before lastSeen is updated for this sighting
+void updateDeviceRSSI(uint16_t pos, int rssi, uint32_t now, bool fresh) {
+    int32_t sample = rssi * 16;
+    uint16_t dt = (uint16_t)now - devices.lastSampleMs[pos];
+    devices.rssi[pos] = (int8_t)rssi;
+    devices.lastSampleMs[pos] = (uint16_t)now;
+    
+    if (fresh || now - devices.lastSeen[pos] > RSSI_RESET_MS) {
+        devices.rssiLevel[pos] = (int16_t)sample;
+        devices.rssiRate[pos] = 0;
+        return;
+    }
+    
+    int32_t level = devices.rssiLevel[pos];
+    int32_t rate = devices.rssiRate[pos];
+    int32_t predicted = level + rate * dt / 1000;
+    int32_t residual = sample - predicted;
+    
+    level = predicted + (residual >> RSSI_ALPHA_SHIFT);
+    if (dt >= RSSI_MIN_DT_MS) {
+        rate += (residual * 1000 / dt) >> RSSI_BETA_SHIFT;
+        if (rate > RSSI_MAX_RATE_Q4) rate = RSSI_MAX_RATE_Q4;
+        if (rate < -RSSI_MAX_RATE_Q4) rate = -RSSI_MAX_RATE_Q4;
+    }
+    
+    devices.rssiLevel[pos] = (int16_t)level;
+    devices.rssiRate[pos] = (int16_t)rate;
+}
+
+RSSITrend rssiTrend(int16_t rate) {
+    if (rate > RSSI_TREND_THRESHOLD_Q4) return TREND_APPROACHING;
+    if (rate < -RSSI_TREND_THRESHOLD_Q4) return TREND_RECEDING;
+    return TREND_STEADY;
+}
+
+// ================================
+// Persistent Device Storage Functions
+// ================================
+// The most recent devices are kept as one versioned blob under the
+// "devices" key: the descriptions they use, then one packed record per
+// device, most recent first. Written with a single putBytes(), as soon as
+// deviceTableGeneration has moved since the last save. Detections of
+// devices already saved only move lastSeen and RSSI, so those are left
+// for DEVICE_SNAPSHOT_REFRESH_MS - saving them on every flush would wear
+// the NVS pages out in months.
+#define DEVICE_SNAPSHOT_KEY "devices"
+#define DEVICE_SNAPSHOT_MAGIC 0x5644534F  // "OSDV"
+#define DEVICE_SNAPSHOT_VERSION 1
+#define DEVICE_SNAPSHOT_RECORD_BYTES 18   // mac 6, lastSeen 4, firstSeen 4, rssi 1, rssiLevel 2, description 1
+#define DEVICE_SNAPSHOT_REFRESH_MS (15UL * 60 * 1000)
+
+uint32_t deviceSnapshotGeneration = 0;
+uint32_t deviceSnapshotSightings = 0;
+uint32_t deviceSnapshotTime = 0;  // millis() of the last save
+bool deviceSnapshotSaved = false;
+
+// Removes the per-field keys written by older firmware
+void removeLegacyDeviceKeys() {
+    if (!preferences.isKey("deviceCount")) return;
+    int legacyCount = preferences.getInt("deviceCount", 0);
+    for (int i = 0; i < legacyCount; i++) {
+        preferences.remove(("dev_mac_" + String(i)).c_str());
+        preferences.remove(("dev_rssi_" + String(i)).c_str());
+        preferences.remove(("dev_time_" + String(i)).c_str());
+        preferences.remove(("dev_filt_" + String(i)).c_str());
+    }
+    preferences.remove("deviceCount");
+}
+
+// One device copied out of the table, so snapshots and /api/devices are
+// built without holding deviceTableLock
+struct DeviceRow {
+    uint64_t mac;
+    uint32_t lastSeen;
+    uint32_t firstSeen;
+    int16_t rssiLevel;
+    int16_t rssiRate;
+    int8_t rssi;
+    uint8_t description;
+};
+
+#define DEVICE_COPY_BATCH 256  // pool positions copied per hold of deviceTableLock
+
+DeviceRow copyDeviceRow(uint16_t pos) {
+    DeviceRow row;
+    row.mac = devices.mac[pos];
+    row.lastSeen = devices.lastSeen[pos];
+    row.firstSeen = devices.firstSeen[pos];
+    row.rssiLevel = devices.rssiLevel[pos];
+    row.rssiRate = devices.rssiRate[pos];
+    row.rssi = devices.rssi[pos];
+    row.description = devices.description[pos];
+    return row;
+}
+
+// Copies up to limit devices, most recent first, in one short hold of the lock
+void copyRecentDevices(std::vector<DeviceRow>& rows, size_t limit) {
+    rows.clear();
+    rows.reserve(limit);
+    xSemaphoreTake(deviceTableLock, portMAX_DELAY);
+    for (uint16_t pos = deviceLRUHead; pos != EMPTY_DEVICE_SLOT && rows.size() < limit; pos = devices.lruNext[pos]) {
+        rows.push_back(copyDeviceRow(pos));
+    }
+    xSemaphoreGive(deviceTableLock);
+}
+
+// Copies every tracked device, most recent first. The pool is copied
+// DEVICE_COPY_BATCH positions at a time, releasing the lock in between so
+// the BLE callback never waits on a full-table walk, then sorted by
+// lastSeen. A device that changes mid-copy may be missed or stale, but
+// that change is also in the journal segment being written and replay
+// applies it on top of the snapshot.
+void copyAllDevices(std::vector<DeviceRow>& rows) {
+    rows.clear();
+    rows.reserve(DEVICE_TABLE_CAPACITY);
+    for (size_t start = 0; start < DEVICE_TABLE_CAPACITY; start += DEVICE_COPY_BATCH) {
+        size_t end = start + DEVICE_COPY_BATCH < DEVICE_TABLE_CAPACITY ? start + DEVICE_COPY_BATCH : DEVICE_TABLE_CAPACITY;
+        xSemaphoreTake(deviceTableLock, portMAX_DELAY);
+        for (size_t pos = start; pos < end; pos++) {
+            // Free records are reset, so only tracked ones are linked or at the head
+            if (devices.lruPrev[pos] != EMPTY_DEVICE_SLOT || pos == deviceLRUHead) {
+                rows.push_back(copyDeviceRow(pos));
+            }
+        }
+        xSemaphoreGive(deviceTableLock);
+    }
+    
+    uint32_t now = millis();
+    std::sort(rows.begin(), rows.end(), [now](const DeviceRow& a, const DeviceRow& b) {
+        return now - a.lastSeen < now - b.lastSeen;
+    });
+}
+
+// Appends the descriptions the rows use and the rows themselves, and
+// returns how many devices were written. Descriptions are renumbered so
+// only the ones in use are stored.
+uint32_t writeDeviceSnapshot(NvsBlobWriter& blob, const std::vector<DeviceRow>& rows) {
+    uint8_t descriptionMap[DESCRIPTION_TABLE_SIZE];
+    memset(descriptionMap, NO_DESCRIPTION, sizeof(descriptionMap));
+    uint8_t usedDescriptions[DESCRIPTION_TABLE_SIZE];
+    uint8_t usedCount = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+        uint8_t description = rows[i].description;
+        if (description < DESCRIPTION_TABLE_SIZE && descriptionMap[description] == NO_DESCRIPTION) {
+            descriptionMap[description] = usedCount;
+            usedDescriptions[usedCount++] = description;
+        }
+    }
+    
+    // Descriptions are only appended while scanning, so the texts are
+    // still the ones the rows were copied with
+    std::vector<String> texts(usedCount);
+    xSemaphoreTake(deviceTableLock, portMAX_DELAY);
+    for (uint8_t i = 0; i < usedCount; i++) {
+        if (usedDescriptions[i] < deviceDescriptions.size()) texts[i] = deviceDescriptions[usedDescriptions[i]];
+    }
+    xSemaphoreGive(deviceTableLock);
+    
+    blob.reserve(1 + rows.size() * DEVICE_SNAPSHOT_RECORD_BYTES);
+    blob.put8(usedCount);
+    for (uint8_t i = 0; i < usedCount; i++) {
+        blob.putString(texts[i].c_str(), texts[i].length());
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+        const DeviceRow& row = rows[i];
+        blob.put48(row.mac);
+        blob.put32(row.lastSeen);
+        blob.put32(row.firstSeen);
+        blob.put8((uint8_t)row.rssi);
+        blob.put16((uint16_t)row.rssiLevel);
+        blob.put8(row.description < DESCRIPTION_TABLE_SIZE ? descriptionMap[row.description] : NO_DESCRIPTION);
+    }
+    return rows.size();
+}
+
+void saveDetectedDevices() {
+    uint32_t now = millis();
+    // Read before copying: a change that lands in between is saved again next time
+    uint32_t generation = deviceTableGeneration;
+    uint32_t sightings = deviceSightings;
+    if (deviceSnapshotSaved && generation == deviceSnapshotGeneration &&
+        (sightings == deviceSnapshotSightings || now - deviceSnapshotTime < DEVICE_SNAPSHOT_REFRESH_MS)) {
+        return;
+    }
+    
+    // Keep only the most recently seen devices to avoid NVS overflow
+    std::vector<DeviceRow> rows;
+    copyRecentDevices(rows, DEVICE_PERSIST_LIMIT);
+    NvsBlobWriter blob(DEVICE_SNAPSHOT_MAGIC, DEVICE_SNAPSHOT_VERSION);
+    uint32_t savedCount = writeDeviceSnapshot(blob, rows);
+    const std::vector<uint8_t>& bytes = blob.finish(savedCount, generation);
+    
+    preferences.begin("ouispy", false);
+    size_t written = preferences.putBytes(DEVICE_SNAPSHOT_KEY, bytes.data(), bytes.size());
+    removeLegacyDeviceKeys();
+    preferences.end();
+    
+    if (written == bytes.size()) {
+        deviceSnapshotGeneration = generation;
+        deviceSnapshotSightings = sightings;
+        deviceSnapshotTime = now;
+        deviceSnapshotSaved = true;
+    }
+}
+
+// Older firmware stored four keys per device; read once so history
+// survives the upgrade. The next save replaces them with the blob.
+void loadLegacyDetectedDevices() {
+    int savedCount = preferences.getInt("deviceCount", 0);
+    
+    // Insert oldest first so the most recent ends up at the front
+    for (int i = savedCount - 1; i >= 0; i--) {
+        String mac = preferences.getString(("dev_mac_" + String(i)).c_str(), "");
+        MacAddr parsedMAC;
+        if (MacAddr::parse(mac.c_str(), parsedMAC) != 6) continue;
+        
+        uint16_t pos = insertDevice(parsedMAC);
+        devices.rssi[pos] = (int8_t)preferences.getInt(("dev_rssi_" + String(i)).c_str(), 0);
+        devices.rssiLevel[pos] = devices.rssi[pos] * 16;
+        devices.lastSeen[pos] = preferences.getULong(("dev_time_" + String(i)).c_str(), 0);
+        devices.firstSeen[pos] = devices.lastSeen[pos];
+        devices.description[pos] = internDescription(preferences.getString(("dev_filt_" + String(i)).c_str(), ""));
+    }
+}
+
+// Inserts the snapshot's devices into the table. generation is set to
+// the value the snapshot was saved with.
+bool applyDeviceSnapshot(const uint8_t* data, size_t length, size_t limit, uint32_t& generation) {
+    NvsBlobReader blob;
+    if (!blob.open(data, length, DEVICE_SNAPSHOT_MAGIC, DEVICE_SNAPSHOT_VERSION)) return false;
+    generation = blob.generation();
+    
+    uint8_t descriptionMap[DESCRIPTION_TABLE_SIZE];
+    uint8_t descriptionCount = blob.get8();
+    for (uint8_t i = 0; i < descriptionCount && !blob.failed(); i++) {
+        uint16_t textLength;
+        const char* text = blob.getString(textLength);
+        descriptionMap[i] = internDescription(String(text, textLength));
+    }
+    
+    // Records are most recent first; insert oldest first so the most
+    // recent ends up at the front
+    size_t records = blob.tell();
+    if (blob.failed() || blob.count() > limit ||
+        blob.payloadSize() - records != (size_t)blob.count() * DEVICE_SNAPSHOT_RECORD_BYTES) {
+        return false;
+    }
+    for (int i = (int)blob.count() - 1; i >= 0; i--) {
+        blob.seek(records + (size_t)i * DEVICE_SNAPSHOT_RECORD_BYTES);
+        MacAddr mac(blob.get48());
+        uint32_t lastSeen = blob.get32();
+        uint32_t firstSeen = blob.get32();
+        int8_t rssi = (int8_t)blob.get8();
+        int16_t rssiLevel = (int16_t)blob.get16();
+        uint8_t description = blob.get8();
+        if (blob.failed()) return false;
+        
+        uint16_t pos = insertDevice(mac);
+        devices.lastSeen[pos] = lastSeen;
+        devices.firstSeen[pos] = firstSeen;
+        devices.rssi[pos] = rssi;
+        devices.rssiLevel[pos] = rssiLevel;
+        devices.description[pos] = description < descriptionCount ? descriptionMap[description] : NO_DESCRIPTION;
+    }
+    return true;
+}
+
+void loadDetectedDevices() {
+    preferences.begin("ouispy", true);
+    clearDeviceTable();
+    
+    size_t length = preferences.getBytesLength(DEVICE_SNAPSHOT_KEY);
+    if (length > 0) {
+        std::vector<uint8_t> data(length);
+        preferences.getBytes(DEVICE_SNAPSHOT_KEY, data.data(), length);
+        uint32_t generation;
+        if (!applyDeviceSnapshot(data.data(), length, DEVICE_PERSIST_LIMIT, generation)) {
+            clearDeviceTable();
+            if (isSerialConnected()) {
+                Serial.println("Device snapshot in NVS is invalid - ignored");
+            }
+        }
+    } else {
+        loadLegacyDetectedDevices();
+    }
+    
     preferences.end();
+    
+    // What was just loaded is what NVS already holds
+    deviceSnapshotGeneration = deviceTableGeneration;
+    deviceSnapshotSightings = deviceSightings;
+    deviceSnapshotTime = millis();
+    deviceSnapshotSaved = length > 0;
+    
+    if (isSerialConnected()) {
+        Serial.println("Detected devices loaded from NVS (" + String(deviceCount) + " devices)");
+    }
 }
 
 // ================================
-// MAC Address Utility Functions
+// Detection Journal (LittleFS)
 // ================================
-void normalizeMACAddress(String& mac) {
-    mac.toLowerCase();
-    mac.replace("-", ":");
-    mac.replace(" ", "");
+// Every published detection is appended as a small framed record to the
+// active segment file. Records are batched in RAM and written every
+// JOURNAL_FLUSH_MS (or when the batch fills), so an event costs a copy
+// plus a share of one append, however large the history grows.
+//
+// When a segment reaches JOURNAL_SEGMENT_BYTES a new one is started and
+// the compaction task writes a snapshot of the device table covering all
+// closed segments. Boot loads the snapshot and replays only the segments
+// after it. Closed segments are kept as history, JOURNAL_KEEP_SEGMENTS
+// back from the snapshot. Replay is idempotent, so a snapshot that already
+// holds some of the newer events is harmless.
+//
+// Frame: JOURNAL_FRAME_MARK, type, payload length, payload, then the
+// CRC-32 (little-endian) of type, length and payload. Replay stops at the
+// first bad frame; a torn tail is never appended to because every boot
+// starts a fresh segment.
+#define JOURNAL_DIR "/journal"
+#define JOURNAL_SNAPSHOT_PATH "/journal/snapshot.bin"
+#define JOURNAL_SNAPSHOT_TEMP "/journal/snapshot.tmp"
+#define JOURNAL_SEGMENT_BYTES (64 * 1024)
+#define JOURNAL_KEEP_SEGMENTS 8
+#define JOURNAL_REPLAY_SEGMENTS 4       // compact at boot if more were replayed
+#define JOURNAL_BUFFER_BYTES 1024
+#define JOURNAL_FLUSH_MS 10000
+#define JOURNAL_FRAME_MARK 0xA5
+#define JOURNAL_FRAME_OVERHEAD 7        // mark, type, length, CRC-32
+#define JOURNAL_MAX_FRAME (JOURNAL_FRAME_OVERHEAD + 255)
+
+enum JournalRecordType : uint8_t {
+    JOURNAL_SEGMENT_START = 1,  // u32 segment sequence, u8 reason; millis() restarts after a boot
+    JOURNAL_DESCRIPTION = 2,    // u8 index, text
+    JOURNAL_DETECTION = 3       // u32 millis, mac 6, i8 rssi, i8 rssiFiltered, u8 type, u8 description
+};
+
+enum JournalSegmentReason : uint8_t {
+    SEGMENT_BOOT,
+    SEGMENT_ROLLOVER,
+    SEGMENT_CLEARED
+};
+
+bool journalReady = false;
+File journalFile;
+SemaphoreHandle_t journalLock = nullptr;    // recursive; guards the file and batch
+TaskHandle_t journalCompactTaskHandle = nullptr;
+uint32_t journalSequence = 0;               // active segment
+uint32_t journalOldestSequence = 0;         // oldest segment still on disk
+uint32_t journalSnapshotSequence = 0;       // newest segment the snapshot covers
+uint32_t journalEpoch = 0;                  // bumped by clearJournal()
+size_t journalSegmentBytes = 0;
+uint8_t journalBuffer[JOURNAL_BUFFER_BYTES];
+size_t journalBuffered = 0;
+uint32_t journalDescribed[(DESCRIPTION_TABLE_SIZE + 31) / 32];  // descriptions already in this segment
+volatile uint32_t journalRecords = 0;
+volatile uint32_t journalBytesWritten = 0;
+volatile uint32_t journalCompactions = 0;
+
+void journalSegmentPath(uint32_t sequence, char* out) {
+    snprintf(out, 32, JOURNAL_DIR "/%08lu.log", (unsigned long)sequence);
 }
 
-bool isValidMAC(const String& mac) {
-    String normalized = mac;
-    normalizeMACAddress(normalized);
-    
-    // Check for valid OUI (8 chars) or full MAC (17 chars)
-    if (normalized.length() != 8 && normalized.length() != 17) {
-        return false;
+// Segment sequence from a "%08lu.log" name, or 0
+uint32_t journalSegmentSequence(const char* name) {
+    const char* base = strrchr(name, '/');
+    base = base ? base + 1 : name;
+    uint32_t sequence = 0;
+    int digits = 0;
+    for (; *base >= '0' && *base <= '9'; base++, digits++) {
+        sequence = sequence * 10 + (*base - '0');
     }
-    
-    // Basic format validation
-    for (int i = 0; i < normalized.length(); i++) {
-        char c = normalized.charAt(i);
-        if (i % 3 == 2) {
-            if (c != ':') return false;
-        } else {
-            if (!isxdigit(c)) return false;
+    return (digits == 8 && strcmp(base, ".log") == 0) ? sequence : 0;
+}
+
+void flushJournal();
+
+void appendJournalFrame(uint8_t type, const uint8_t* payload, uint8_t length) {
+    xSemaphoreTakeRecursive(journalLock, portMAX_DELAY);
+    if (journalBuffered + JOURNAL_FRAME_OVERHEAD + length > JOURNAL_BUFFER_BYTES) {
+        flushJournal();
+        if (journalBuffered + JOURNAL_FRAME_OVERHEAD + length > JOURNAL_BUFFER_BYTES) {
+            xSemaphoreGiveRecursive(journalLock);
+            return;
         }
     }
+    uint8_t* frame = journalBuffer + journalBuffered;
+    frame[0] = JOURNAL_FRAME_MARK;
+    frame[1] = type;
+    frame[2] = length;
+    memcpy(frame + 3, payload, length);
+    uint32_t crc = crc32(frame + 1, 2 + length);
+    for (int i = 0; i < 4; i++) {
+        frame[3 + length + i] = (uint8_t)(crc >> (8 * i));
+    }
+    journalBuffered += JOURNAL_FRAME_OVERHEAD + length;
+    journalRecords++;
+    xSemaphoreGiveRecursive(journalLock);
+}
+
+bool openJournalSegment(uint32_t sequence, JournalSegmentReason reason) {
+    char path[32];
+    journalSegmentPath(sequence, path);
+    journalFile = LittleFS.open(path, FILE_APPEND);
+    if (!journalFile) return false;
+    
+    journalSequence = sequence;
+    journalSegmentBytes = journalFile.size();
+    memset(journalDescribed, 0, sizeof(journalDescribed));
     
+    uint8_t payload[5] = {(uint8_t)sequence, (uint8_t)(sequence >> 8), (uint8_t)(sequence >> 16),
+                          (uint8_t)(sequence >> 24), reason};
+    appendJournalFrame(JOURNAL_SEGMENT_START, payload, sizeof(payload));
     return true;
 }
 
-bool matchesTargetFilter(const String& deviceMAC, String& matchedDescription) {
-    String normalizedDeviceMAC = deviceMAC;
-    normalizeMACAddress(normalizedDeviceMAC);
+// Writes the batch to the active segment and starts a new segment (and a
+// compaction) once it is full. Called from loop() and when the batch fills.
+void flushJournal() {
+    if (!journalReady) return;
+    xSemaphoreTakeRecursive(journalLock, portMAX_DELAY);
     
-    for (const TargetFilter& filter : targetFilters) {
-        String filterID = filter.identifier;
-        normalizeMACAddress(filterID);
-        
-        if (filter.isFullMAC) {
-            if (normalizedDeviceMAC.equals(filterID)) {
-                matchedDescription = filter.description;
-                return true;
-            }
+    if (journalBuffered > 0) {
+        size_t written = journalFile.write(journalBuffer, journalBuffered);
+        journalFile.flush();
+        journalSegmentBytes += written;
+        journalBytesWritten += written;
+        journalBuffered = 0;
+    }
+    
+    if (journalSegmentBytes >= JOURNAL_SEGMENT_BYTES) {
+        journalFile.close();
+        if (openJournalSegment(journalSequence + 1, SEGMENT_ROLLOVER)) {
+            xTaskNotifyGive(journalCompactTaskHandle);
         } else {
-            if (normalizedDeviceMAC.startsWith(filterID)) {
-                matchedDescription = filter.description;
-                return true;
-            }
+            journalReady = false;
         }
     }
-    return false;
+    
+    xSemaphoreGiveRecursive(journalLock);
 }
 
-// ================================
-// Device Alias Functions
-// ================================
-void saveDeviceAliases() {
-    preferences.begin("ouispy", false);
-    preferences.putInt("aliasCount", deviceAliases.size());
+// Called from loop() for each event drained from detectionEvents
+void journalDetection(const DetectionEvent& event) {
+    if (!journalReady) return;
+    xSemaphoreTakeRecursive(journalLock, portMAX_DELAY);
     
-    for (int i = 0; i < deviceAliases.size(); i++) {
-        String keyMac = "alias_mac_" + String(i);
-        String keyName = "alias_name_" + String(i);
-        
-        preferences.putString(keyMac.c_str(), deviceAliases[i].macAddress);
-        preferences.putString(keyName.c_str(), deviceAliases[i].alias);
+    // Each segment names the descriptions it uses before their first use
+    uint8_t description = event.description;
+    uint8_t descriptionPayload[256];
+    size_t descriptionLength = 0;
+    xSemaphoreTake(deviceTableLock, portMAX_DELAY);
+    if (description < deviceDescriptions.size()) {
+        const String& text = deviceDescriptions[description];
+        descriptionLength = text.length() < 254 ? text.length() : 254;
+        descriptionPayload[0] = description;
+        memcpy(descriptionPayload + 1, text.c_str(), descriptionLength);
+        descriptionLength++;
     }
+    xSemaphoreGive(deviceTableLock);
     
-    preferences.end();
-    
-    if (isSerialConnected()) {
-        Serial.println("Device aliases saved to NVS (" + String(deviceAliases.size()) + " aliases)");
+    // A flush may start a new segment, so make room for both frames before
+    // writing either; a batch always lands whole in one segment
+    if (journalBuffered + 2 * JOURNAL_FRAME_OVERHEAD + descriptionLength + 14 > JOURNAL_BUFFER_BYTES) {
+        flushJournal();
+        if (!journalReady) {
+            xSemaphoreGiveRecursive(journalLock);
+            return;
+        }
+    }
+    if (descriptionLength > 0 && !(journalDescribed[description / 32] & (1UL << (description % 32)))) {
+        appendJournalFrame(JOURNAL_DESCRIPTION, descriptionPayload, (uint8_t)descriptionLength);
+        journalDescribed[description / 32] |= 1UL << (description % 32);
     }
+    
+    uint8_t payload[14];
+    for (int i = 0; i < 4; i++) payload[i] = (uint8_t)(event.timestamp >> (8 * i));
+    for (int i = 0; i < 6; i++) payload[4 + i] = (uint8_t)(event.mac >> (8 * i));
+    payload[10] = (uint8_t)event.rssi;
+    payload[11] = (uint8_t)event.rssiFiltered;
+    payload[12] = event.type;
+    payload[13] = description;
+    appendJournalFrame(JOURNAL_DETECTION, payload, sizeof(payload));
+    
+    xSemaphoreGiveRecursive(journalLock);
 }
 
-void loadDeviceAliases() {
-    preferences.begin("ouispy", true);
-    int aliasCount = preferences.getInt("aliasCount", 0);
+// Applies one segment's records to the device table. Returns false if
+// there is no such segment. Replay stops at the first torn or corrupt
+// frame; everything before it is kept.
+bool replayJournalSegment(uint32_t sequence) {
+    char path[32];
+    journalSegmentPath(sequence, path);
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file) return false;
     
-    deviceAliases.clear();
+    uint8_t descriptionMap[DESCRIPTION_TABLE_SIZE];
+    memset(descriptionMap, NO_DESCRIPTION, sizeof(descriptionMap));
     
-    for (int i = 0; i < aliasCount; i++) {
-        String keyMac = "alias_mac_" + String(i);
-        String keyName = "alias_name_" + String(i);
+    // Frames are at most JOURNAL_MAX_FRAME bytes, so a window twice that
+    // size always holds the next whole frame after a refill
+    uint8_t window[2 * JOURNAL_MAX_FRAME];
+    size_t filled = 0;
+    size_t pos = 0;
+    while (true) {
+        if (filled - pos < JOURNAL_MAX_FRAME) {
+            memmove(window, window + pos, filled - pos);
+            filled -= pos;
+            pos = 0;
+            filled += file.read(window + filled, sizeof(window) - filled);
+        }
+        if (pos == filled) break;
         
-        DeviceAlias alias;
-        alias.macAddress = preferences.getString(keyMac.c_str(), "");
-        alias.alias = preferences.getString(keyName.c_str(), "");
+        const uint8_t* frame = window + pos;
+        size_t available = filled - pos;
+        if (available < JOURNAL_FRAME_OVERHEAD || frame[0] != JOURNAL_FRAME_MARK ||
+            available < (size_t)JOURNAL_FRAME_OVERHEAD + frame[2]) {
+            break;
+        }
+        uint8_t type = frame[1];
+        uint8_t length = frame[2];
+        const uint8_t* payload = frame + 3;
+        uint32_t crc = payload[length] | (payload[length + 1] << 8) | (payload[length + 2] << 16) |
+                       ((uint32_t)payload[length + 3] << 24);
+        if (crc32(frame + 1, 2 + length) != crc) {
+            break;
+        }
+        pos += JOURNAL_FRAME_OVERHEAD + length;
         
-        if (alias.macAddress.length() > 0 && alias.alias.length() > 0) {
-            deviceAliases.push_back(alias);
+        if (type == JOURNAL_DESCRIPTION && length >= 1 && payload[0] < DESCRIPTION_TABLE_SIZE) {
+            descriptionMap[payload[0]] = internDescription(String((const char*)payload + 1, length - 1));
+        } else if (type == JOURNAL_DETECTION && length >= 14) {
+            uint32_t timestamp = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t)payload[3] << 24);
+            uint64_t mac = 0;
+            for (int i = 5; i >= 0; i--) mac = (mac << 8) | payload[4 + i];
+            
+            uint16_t dev = insertDevice(MacAddr(mac));
+            if (payload[12] == DETECTION_NEW || devices.firstSeen[dev] == 0) {
+                devices.firstSeen[dev] = timestamp;
+            }
+            devices.lastSeen[dev] = timestamp;
+            devices.rssi[dev] = (int8_t)payload[10];
+            devices.rssiLevel[dev] = (int8_t)payload[11] * 16;
+            devices.rssiRate[dev] = 0;
+            if (payload[13] < DESCRIPTION_TABLE_SIZE && descriptionMap[payload[13]] != NO_DESCRIPTION) {
+                devices.description[dev] = descriptionMap[payload[13]];
+            }
         }
     }
     
-    preferences.end();
-    
-    if (isSerialConnected()) {
-        Serial.println("Device aliases loaded from NVS (" + String(deviceAliases.size()) + " aliases)");
-    }
+    file.close();
+    return true;
 }
 
-String getDeviceAlias(const String& macAddress) {
-    String normalizedMAC = macAddress;
-    normalizeMACAddress(normalizedMAC);
+// Writes a snapshot of the device table covering every closed segment,
+// then drops segments that have fallen out of the kept history
+void compactJournal() {
+    xSemaphoreTakeRecursive(journalLock, portMAX_DELAY);
+    uint32_t covered = journalSequence - 1;
+    uint32_t epoch = journalEpoch;
+    xSemaphoreGiveRecursive(journalLock);
+    if (covered <= journalSnapshotSequence) return;
     
-    for (const DeviceAlias& alias : deviceAliases) {
-        String normalizedAliasMAC = alias.macAddress;
-        normalizeMACAddress(normalizedAliasMAC);
-        
-        if (normalizedAliasMAC.equals(normalizedMAC)) {
-            return alias.alias;
+    NvsBlobWriter blob(DEVICE_SNAPSHOT_MAGIC, DEVICE_SNAPSHOT_VERSION);
+    uint32_t savedCount;
+    {
+        std::vector<DeviceRow> rows;
+        copyAllDevices(rows);
+        savedCount = writeDeviceSnapshot(blob, rows);
+    }
+    const std::vector<uint8_t>& bytes = blob.finish(savedCount, covered);
+    
+    File file = LittleFS.open(JOURNAL_SNAPSHOT_TEMP, FILE_WRITE);
+    if (!file) return;
+    size_t written = file.write(bytes.data(), bytes.size());
+    file.close();
+    
+    xSemaphoreTakeRecursive(journalLock, portMAX_DELAY);
+    // A clear while the snapshot was being written makes it stale
+    if (written == bytes.size() && epoch == journalEpoch && LittleFS.rename(JOURNAL_SNAPSHOT_TEMP, JOURNAL_SNAPSHOT_PATH)) {
+        journalSnapshotSequence = covered;
+        journalCompactions++;
+        while (journalOldestSequence + JOURNAL_KEEP_SEGMENTS < covered) {
+            char path[32];
+            journalSegmentPath(journalOldestSequence, path);
+            LittleFS.remove(path);
+            journalOldestSequence++;
         }
+    } else {
+        LittleFS.remove(JOURNAL_SNAPSHOT_TEMP);
+    }
+    xSemaphoreGiveRecursive(journalLock);
+}
+
+void journalCompactTask(void* parameter) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        compactJournal();
+    }
+}
+
+// Mounts LittleFS; false leaves device history in NVS only
+bool initJournal() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("LittleFS mount failed - device history stays in NVS");
+        return false;
+    }
+    if (!LittleFS.exists(JOURNAL_DIR)) {
+        LittleFS.mkdir(JOURNAL_DIR);
     }
     
-    return ""; // No alias found
+    journalLock = xSemaphoreCreateRecursiveMutex();
+    xTaskCreate(journalCompactTask, "journalCompact", 4096, nullptr, 1, &journalCompactTaskHandle);
+    return true;
 }
 
-void setDeviceAlias(const String& macAddress, const String& alias) {
-    String normalizedMAC = macAddress;
-    normalizeMACAddress(normalizedMAC);
+// Rebuilds the device table from the snapshot and newer segments, then
+// starts a new segment for this boot. Falls back to the NVS snapshot when
+// the journal is empty, e.g. on the first boot after an upgrade.
+void replayJournal() {
+    unsigned long startTime = millis();
+    clearDeviceTable();
     
-    // Check if alias already exists, update it
-    for (auto& deviceAlias : deviceAliases) {
-        String normalizedAliasMAC = deviceAlias.macAddress;
-        normalizeMACAddress(normalizedAliasMAC);
-        
-        if (normalizedAliasMAC.equals(normalizedMAC)) {
-            if (alias.length() > 0) {
-                deviceAlias.alias = alias;
-            } else {
-                // Remove alias if empty - find and remove the entry
-                for (size_t i = 0; i < deviceAliases.size(); i++) {
-                    String mac = deviceAliases[i].macAddress;
-                    normalizeMACAddress(mac);
-                    if (mac.equals(normalizedMAC)) {
-                        deviceAliases.erase(deviceAliases.begin() + i);
-                        break;
-                    }
-                }
-            }
-            return;
+    uint32_t covered = 0;
+    File snapshot = LittleFS.open(JOURNAL_SNAPSHOT_PATH, FILE_READ);
+    if (snapshot) {
+        std::vector<uint8_t> data(snapshot.size());
+        size_t length = snapshot.read(data.data(), data.size());
+        snapshot.close();
+        if (!applyDeviceSnapshot(data.data(), length, DEVICE_TABLE_CAPACITY, covered)) {
+            clearDeviceTable();
+            covered = 0;
+            Serial.println("Journal snapshot is invalid - replaying segments only");
         }
     }
     
-    // Add new alias if not empty
-    if (alias.length() > 0) {
-        DeviceAlias newAlias;
-        newAlias.macAddress = normalizedMAC;
-        newAlias.alias = alias;
-        deviceAliases.push_back(newAlias);
+    uint32_t oldest = 0;
+    uint32_t newest = 0;
+    File dir = LittleFS.open(JOURNAL_DIR);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+        uint32_t sequence = journalSegmentSequence(entry.name());
+        if (sequence == 0) continue;
+        if (oldest == 0 || sequence < oldest) oldest = sequence;
+        if (sequence > newest) newest = sequence;
     }
-}
-
-// ================================
-// Persistent Device Storage Functions
-// ================================
-void saveDetectedDevices() {
-    preferences.begin("ouispy", false);
+    dir.close();
     
-    // Limit to 100 most recent devices to avoid NVS overflow
-    int deviceCount = min((int)devices.size(), 100);
-    preferences.putInt("deviceCount", deviceCount);
+    // Segments already deleted by compaction are skipped, not counted
+    int replayed = 0;
+    for (uint32_t sequence = covered + 1; sequence <= newest; sequence++) {
+        if (replayJournalSegment(sequence)) replayed++;
+    }
     
-    for (int i = 0; i < deviceCount; i++) {
-        String keyMac = "dev_mac_" + String(i);
-        String keyRssi = "dev_rssi_" + String(i);
-        String keyTime = "dev_time_" + String(i);
-        String keyFilt = "dev_filt_" + String(i);
-        
-        preferences.putString(keyMac.c_str(), devices[i].macAddress);
-        preferences.putInt(keyRssi.c_str(), devices[i].rssi);
-        preferences.putULong(keyTime.c_str(), devices[i].lastSeen);
-        preferences.putString(keyFilt.c_str(), devices[i].filterDescription);
+    bool migrated = false;
+    if (covered == 0 && newest == 0) {
+        loadDetectedDevices();
+        migrated = deviceCount > 0;
     }
     
-    preferences.end();
+    journalSnapshotSequence = covered;
+    journalOldestSequence = oldest ? oldest : newest + 1;
+    journalBuffered = 0;
+    journalReady = openJournalSegment((newest > covered ? newest : covered) + 1, SEGMENT_BOOT);
+    if (journalReady && (migrated || replayed > JOURNAL_REPLAY_SEGMENTS)) {
+        xTaskNotifyGive(journalCompactTaskHandle);
+    }
+    
+    Serial.println("Journal replayed: " + String(deviceCount) + " devices from snapshot " + String(covered) +
+                   " + " + String(replayed) + " segments in " + String(millis() - startTime) + " ms");
 }
 
-void loadDetectedDevices() {
-    preferences.begin("ouispy", true);
-    int deviceCount = preferences.getInt("deviceCount", 0);
+// Deletes all journal files and starts again from segment 1
+void clearJournal() {
+    if (journalLock == nullptr) return;
+    xSemaphoreTakeRecursive(journalLock, portMAX_DELAY);
     
-    devices.clear();
-    
-    for (int i = 0; i < deviceCount; i++) {
-        String keyMac = "dev_mac_" + String(i);
-        String keyRssi = "dev_rssi_" + String(i);
-        String keyTime = "dev_time_" + String(i);
-        String keyFilt = "dev_filt_" + String(i);
-        
-        DeviceInfo device;
-        device.macAddress = preferences.getString(keyMac.c_str(), "");
-        device.rssi = preferences.getInt(keyRssi.c_str(), 0);
-        device.lastSeen = preferences.getULong(keyTime.c_str(), 0);
-        device.filterDescription = preferences.getString(keyFilt.c_str(), "");
-        device.firstSeen = device.lastSeen;
-        device.inCooldown = false;
-        device.cooldownUntil = 0;
-        device.matchedFilter = nullptr;
-        
-        if (device.macAddress.length() > 0) {
-            devices.push_back(device);
-        }
+    if (journalFile) journalFile.close();
+    File dir = LittleFS.open(JOURNAL_DIR);
+    std::vector<String> paths;
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+        paths.push_back(String(JOURNAL_DIR "/") + entry.name());
+    }
+    dir.close();
+    for (size_t i = 0; i < paths.size(); i++) {
+        LittleFS.remove(paths[i].c_str());
     }
     
-    preferences.end();
+    journalEpoch++;
+    journalBuffered = 0;
+    journalSnapshotSequence = 0;
+    journalOldestSequence = 1;
+    journalReady = openJournalSegment(1, SEGMENT_CLEARED);
     
-    if (isSerialConnected()) {
-        Serial.println("Detected devices loaded from NVS (" + String(deviceCount) + " devices)");
-    }
+    xSemaphoreGiveRecursive(journalLock);
 }
 
 void clearDetectedDevices() {
-    devices.clear();
+    xSemaphoreTake(deviceTableLock, portMAX_DELAY);
+    clearDeviceTable();
+    xSemaphoreGive(deviceTableLock);
+    clearJournal();
     
     preferences.begin("ouispy", false);
-    preferences.putInt("deviceCount", 0);
+    preferences.remove(DEVICE_SNAPSHOT_KEY);
+    removeLegacyDeviceKeys();
     preferences.end();
+    deviceSnapshotGeneration = deviceTableGeneration;
+    deviceSnapshotSightings = deviceSightings;
+    deviceSnapshotSaved = true;
     
     if (isSerialConnected()) {
-        Serial.println("All detected devices cleared from memory and NVS");
+        Serial.println("All detected devices cleared from memory, NVS and journal");
     }
 }
 
@@ -1160,7 +3393,7 @@ const char* getConfigHTML() {
         <h1>OUI-SPY Detector</h1>
         
         <div class="status">
-            Enter MAC addresses and/or OUI prefixes below. You must provide at least one entry in either field.
+            Enter MAC addresses and/or OUI prefixes below, or enable a built-in OUI category. You must provide at least one.
         </div>
 
         <form id="configForm" method="POST" action="/save">
@@ -1172,7 +3405,8 @@ DD:EE:FF
 11:22:33">%OUI_VALUES%</textarea>
                 <div class="help-text">
                     OUI prefixes (first 3 bytes) match all devices from a manufacturer.<br>
-                    Format: XX:XX:XX (8 characters with colons)
+                    Format: XX:XX:XX, or IEEE MA-M/MA-S blocks XX:XX:XX:X / XX:XX:XX:XX:X, or any length as XX:XX:XX:XX/30.<br>
+                    The most specific matching prefix wins.
                 </div>
             </div>
             
@@ -1188,6 +3422,38 @@ DD:EE:FF:ab:cd:ef
                 </div>
             </div>
             
+            <div class="section">
+                <h3>Advertisement Payload</h3>
+                <textarea name="payloads" placeholder="Enter payload filters, one per line:
+company:004c
+uuid:fd5a
+name:Axon">%PAYLOAD_VALUES%</textarea>
+                <div class="help-text">
+                    Match devices with randomized addresses by what they advertise.<br>
+                    Format: company:XXXX (manufacturer company ID), uuid:XXXX or uuid:128-bit-uuid (service UUID), name:Prefix (local name, case-sensitive)
+                </div>
+            </div>
+            
+            <div class="section">
+                <h3>Identity Resolving Keys</h3>
+                <textarea name="irks" placeholder="Enter IRKs of your own devices, one per line:
+00112233445566778899aabbccddeeff Test Phone">%IRK_VALUES%</textarea>
+                <div class="help-text">
+                    Follows devices you own across private address rotation. Resolved devices are tracked under one stable identity.<br>
+                    Format: 32 hex digits (most significant byte first), then an optional name
+                </div>
+            </div>
+            
+            <div class="section">
+                <h3>Built-in OUI Database</h3>
+                <div class="toggle-container">
+%BUILTIN_VENDORS%
+                </div>
+                <div class="help-text">
+                    Curated vendor OUI lists compiled into the firmware from ouis.md. No need to paste them above.
+                </div>
+            </div>
+            
             <div class="section">
                 <h3>Audio & Visual Settings</h3>
                 <div class="toggle-container">
@@ -1204,6 +3470,15 @@ DD:EE:FF:ab:cd:ef
                 </div>
             </div>
             
+            <div class="section">
+                <h3>Device History</h3>
+                <div>
+                    <label for="deviceLimit" style="display: block; margin-bottom: 8px; font-weight: 500; color: #ffffff;">Tracked Devices</label>
+                    <input type="number" id="deviceLimit" name="deviceLimit" value="%DEVICE_LIMIT%" min="1" max="%DEVICE_CAPACITY%" style="width: 100%; padding: 12px; border: 1px solid rgba(255, 255, 255, 0.2); border-radius: 8px; background: rgba(255, 255, 255, 0.02); color: #ffffff; font-size: 14px;">
+                    <div class="help-text" style="margin-top: 5px;">Up to %DEVICE_CAPACITY%. When full, the least recently seen device is forgotten.</div>
+                </div>
+            </div>
+            
             <div class="section">
                 <h3>WiFi Access Point Settings</h3>
                 <div class="help-text" style="margin-bottom: 15px;">
@@ -1633,15 +3908,19 @@ String generateConfigHTML() {
     String html = getConfigHTML();
     String ouiValues = "";
     String macValues = "";
+    String payloadValues = "";
     
     // Populate existing saved values (if any)
     for (const TargetFilter& filter : targetFilters) {
-        if (filter.isFullMAC) {
+        if (!filter.isMAC()) {
+            if (payloadValues.length() > 0) payloadValues += "\n";
+            payloadValues += formatFilter(filter);
+        } else if (filter.isFullMAC()) {
             if (macValues.length() > 0) macValues += "\n";
-            macValues += filter.identifier;
+            macValues += formatFilter(filter);
         } else {
             if (ouiValues.length() > 0) ouiValues += "\n";
-            ouiValues += filter.identifier;
+            ouiValues += formatFilter(filter);
         }
     }
     
@@ -1658,12 +3937,36 @@ String generateConfigHTML() {
     
     html.replace("%OUI_VALUES%", ouiValues);
     html.replace("%MAC_VALUES%", macValues);
+    html.replace("%PAYLOAD_VALUES%", payloadValues);
+    
+    String irkValues = "";
+    for (const IdentityKey& key : identityKeys) {
+        if (irkValues.length() > 0) irkValues += "\n";
+        irkValues += formatIRK(key.irk);
+        if (key.name.length() > 0) irkValues += " " + key.name;
+    }
+    html.replace("%IRK_VALUES%", irkValues);
     
     // Replace toggle states
     html.replace("%BUZZER_CHECKED%", buzzerEnabled ? "checked" : "");
     html.replace("%LED_CHECKED%", ledEnabled ? "checked" : "");
     
+    // Built-in vendor category toggles
+    String builtinVendors = "";
+    for (int i = 0; i < OUI_DB_VENDOR_COUNT; i++) {
+        String id = "builtin_" + String(i);
+        builtinVendors += "                    <div class=\"toggle-item\">\n";
+        builtinVendors += "                        <input type=\"checkbox\" id=\"" + id + "\" name=\"" + id + "\"";
+        builtinVendors += (builtinVendorMask & (1UL << i)) ? " checked>\n" : ">\n";
+        builtinVendors += "                        <label class=\"toggle-label\" for=\"" + id + "\">" + String(OUI_DB_VENDORS[i].name) + "</label>\n";
+        builtinVendors += "                        <div class=\"help-text\" style=\"margin-top: 0;\">" + String(OUI_DB_VENDORS[i].category) + "</div>\n";
+        builtinVendors += "                    </div>\n";
+    }
+    html.replace("%BUILTIN_VENDORS%", builtinVendors);
+    
     // Replace WiFi credentials
+    html.replace("%DEVICE_LIMIT%", String(deviceTableLimit));
+    html.replace("%DEVICE_CAPACITY%", String(DEVICE_TABLE_CAPACITY));
     html.replace("%AP_SSID%", AP_SSID);
     html.replace("%AP_PASSWORD%", AP_PASSWORD);
     
@@ -1673,6 +3976,85 @@ String generateConfigHTML() {
 // ================================
 // WiFi and Web Server Functions
 // ================================
+// /api/devices goes out as a chunked response, so the full table never
+// sits in one String. Rows are copied up front (most recent first), then
+// formatted DEVICE_JSON_BATCH at a time as the socket drains, holding
+// deviceTableLock only to look up each batch's descriptions.
+#define DEVICE_JSON_BATCH 32
+
+struct DeviceListResponse {
+    std::vector<DeviceRow> rows;
+    size_t next = 0;         // next row to format
+    String pending;          // formatted, not yet sent
+    size_t pendingSent = 0;
+    unsigned long currentTime = 0;
+    bool started = false;
+    bool finished = false;
+};
+
+void formatDeviceBatch(DeviceListResponse& list) {
+    list.pending = "";
+    list.pendingSent = 0;
+    if (!list.started) {
+        list.pending = "{\"devices\":[";
+        list.started = true;
+    }
+    
+    size_t end = list.next + DEVICE_JSON_BATCH < list.rows.size() ? list.next + DEVICE_JSON_BATCH : list.rows.size();
+    xSemaphoreTake(deviceTableLock, portMAX_DELAY);
+    for (; list.next < end; list.next++) {
+        const DeviceRow& row = list.rows[list.next];
+        if (list.next > 0) list.pending += ",";
+        
+        MacAddr mac(row.mac);
+        const char* alias = getDeviceAlias(mac);
+        
+        // Calculate time since last seen
+        unsigned long timeSince = (list.currentTime >= row.lastSeen) ? (list.currentTime - row.lastSeen) : 0;
+        
+        list.pending += "{";
+        list.pending += "\"mac\":\"" + formatMAC(mac) + "\",";
+        list.pending += "\"rssi\":" + String(row.rssi) + ",";
+        list.pending += "\"rssiFiltered\":" + String(row.rssiLevel / 16.0f, 1) + ",";
+        list.pending += "\"slope\":" + String(row.rssiRate / 16.0f, 2) + ",";
+        list.pending += "\"trend\":\"" + String(RSSI_TREND_NAMES[rssiTrend(row.rssiRate)]) + "\",";
+        list.pending += "\"filter\":\"" + descriptionText(row.description) + "\",";
+        list.pending += "\"alias\":\"";
+        list.pending += alias;
+        list.pending += "\",";
+        list.pending += "\"lastSeen\":" + String(row.lastSeen) + ",";
+        list.pending += "\"timeSince\":" + String(timeSince);
+        list.pending += "}";
+    }
+    xSemaphoreGive(deviceTableLock);
+    
+    if (list.next == list.rows.size()) {
+        list.pending += "],";
+        list.pending += "\"capacity\":" + String(deviceTableLimit) + ",";
+        list.pending += "\"loadFactor\":" + String(deviceTableLoadFactor(), 3) + ",";
+        list.pending += "\"currentTime\":" + String(list.currentTime);
+        list.pending += "}";
+        list.finished = true;
+    }
+}
+
+// Chunked response filler: returns the bytes written, 0 once done
+size_t fillDeviceList(DeviceListResponse& list, uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+        if (list.pendingSent == list.pending.length()) {
+            if (list.finished) break;
+            formatDeviceBatch(list);
+        }
+        size_t chunk = list.pending.length() - list.pendingSent;
+        if (chunk > maxLen - written) chunk = maxLen - written;
+        memcpy(buffer + written, list.pending.c_str() + list.pendingSent, chunk);
+        list.pendingSent += chunk;
+        written += chunk;
+    }
+    return written;
+}
+
 void startConfigMode() {
     currentMode = CONFIG_MODE;
     // configStartTime will be set AFTER AP is fully ready
@@ -1751,11 +4133,9 @@ void startConfigMode() {
                     oui.trim();
                     oui.replace("\r", ""); // Remove carriage returns
                     
-                    if (oui.length() > 0 && isValidMAC(oui)) {
-                        TargetFilter filter;
-                        filter.identifier = oui;
-                        filter.description = "OUI: " + oui;
-                        filter.isFullMAC = false;
+                    TargetFilter filter;
+                    if (oui.length() > 0 && targetFilters.size() < MAX_TARGET_FILTERS && parseFilterSpec(oui, filter)) {
+                        filter.description = defaultFilterDescription(filter);
                         targetFilters.push_back(filter);
                     }
                 }
@@ -1786,17 +4166,104 @@ void startConfigMode() {
                     mac.trim();
                     mac.replace("\r", ""); // Remove carriage returns
                     
-                    if (mac.length() > 0 && isValidMAC(mac)) {
-                        TargetFilter filter;
-                        filter.identifier = mac;
-                        filter.description = "MAC: " + mac;
-                        filter.isFullMAC = true;
+                    TargetFilter filter;
+                    if (mac.length() > 0 && targetFilters.size() < MAX_TARGET_FILTERS && parseFilterSpec(mac, filter)) {
+                        filter.description = defaultFilterDescription(filter);
+                        targetFilters.push_back(filter);
+                    }
+                }
+            }
+        }
+        
+        // Process advertisement payload entries
+        if (request->hasParam("payloads", true)) {
+            String payloadData = request->getParam("payloads", true)->value();
+            payloadData.trim();
+            
+            if (payloadData.length() > 0) {
+                // Split by newlines and process each payload filter
+                int start = 0;
+                int end = payloadData.indexOf('\n');
+                
+                while (start < payloadData.length()) {
+                    String spec;
+                    if (end == -1) {
+                        spec = payloadData.substring(start);
+                        start = payloadData.length();
+                    } else {
+                        spec = payloadData.substring(start, end);
+                        start = end + 1;
+                        end = payloadData.indexOf('\n', start);
+                    }
+                    
+                    spec.trim();
+                    spec.replace("\r", ""); // Remove carriage returns
+                    
+                    TargetFilter filter;
+                    if (spec.length() > 0 && targetFilters.size() < MAX_TARGET_FILTERS && parseFilterSpec(spec, filter)) {
+                        filter.description = defaultFilterDescription(filter);
                         targetFilters.push_back(filter);
                     }
                 }
             }
         }
         
+        // Process identity resolving keys
+        if (request->hasParam("irks", true)) {
+            String irkData = request->getParam("irks", true)->value();
+            irkData.trim();
+            identityKeys.clear();
+            
+            if (irkData.length() > 0) {
+                // Split by newlines and process each IRK
+                int start = 0;
+                int end = irkData.indexOf('\n');
+                
+                while (start < irkData.length()) {
+                    String line;
+                    if (end == -1) {
+                        line = irkData.substring(start);
+                        start = irkData.length();
+                    } else {
+                        line = irkData.substring(start, end);
+                        start = end + 1;
+                        end = irkData.indexOf('\n', start);
+                    }
+                    
+                    line.trim();
+                    line.replace("\r", ""); // Remove carriage returns
+                    
+                    int space = line.indexOf(' ');
+                    IdentityKey key;
+                    if (parseIRK(space > 0 ? line.substring(0, space) : line, key.irk)) {
+                        key.identity = identityForIRK(key.irk);
+                        key.name = space > 0 ? line.substring(space + 1) : "";
+                        key.name.trim();
+                        if (key.name.length() == 0) key.name = "IRK " + String(identityKeys.size() + 1);
+                        identityKeys.push_back(key);
+                    }
+                }
+            }
+            resetRPACache();
+        }
+        
+        // Process built-in vendor categories
+        builtinVendorMask = 0;
+        for (int i = 0; i < OUI_DB_VENDOR_COUNT; i++) {
+            if (request->hasParam("builtin_" + String(i), true)) {
+                builtinVendorMask |= (1UL << i);
+            }
+        }
+        
+        rebuildFilterIndex();
+        
+        if (request->hasParam("deviceLimit", true)) {
+            long limit = request->getParam("deviceLimit", true)->value().toInt();
+            if (limit > 0) {
+                setDeviceTableLimit(limit);
+            }
+        }
+        
         // Process buzzer and LED toggles
         buzzerEnabled = request->hasParam("buzzerEnabled", true);
         ledEnabled = request->hasParam("ledEnabled", true);
@@ -1829,14 +4296,18 @@ void startConfigMode() {
             Serial.println("WiFi Password: " + String(AP_PASSWORD.length() > 0 ? "********" : "(Open Network)"));
         }
         
-        if (targetFilters.size() > 0) {
+        if (hasActiveFilters()) {
             saveConfiguration();
             
             if (isSerialConnected()) {
                 Serial.println("Saved " + String(targetFilters.size()) + " filters:");
                 for (const TargetFilter& filter : targetFilters) {
-                    String type = filter.isFullMAC ? "Full MAC" : "OUI";
-                    Serial.println("  - " + filter.identifier + " (" + type + ")");
+                    Serial.println("  - " + formatFilter(filter) + " (" + filterTypeName(filter) + ")");
+                }
+                for (int i = 0; i < OUI_DB_VENDOR_COUNT; i++) {
+                    if (builtinVendorMask & (1UL << i)) {
+                        Serial.println("  - Built-in: " + describeBuiltinVendor(i));
+                    }
                 }
             }
             
@@ -1920,6 +4391,7 @@ void startConfigMode() {
         
         // Clear all filters
         targetFilters.clear();
+        rebuildFilterIndex();
         saveConfiguration();
         
         if (isSerialConnected()) {
@@ -1952,38 +4424,14 @@ void startConfigMode() {
     server.on("/api/devices", HTTP_GET, [](AsyncWebServerRequest *request) {
         lastConfigActivity = millis();
         
-        String json = "{\"devices\":[";
-        
-        unsigned long currentTime = millis();
-        
-        for (size_t i = 0; i < devices.size(); i++) {
-            if (i > 0) json += ",";
-            
-            String alias = getDeviceAlias(devices[i].macAddress);
-            String filterDesc = devices[i].filterDescription;
-            if (filterDesc.length() == 0 && devices[i].matchedFilter) {
-                filterDesc = String(devices[i].matchedFilter);
-            }
-            
-            // Calculate time since last seen
-            unsigned long timeSince = (currentTime >= devices[i].lastSeen) ? 
-                                     (currentTime - devices[i].lastSeen) : 0;
-            
-            json += "{";
-            json += "\"mac\":\"" + devices[i].macAddress + "\",";
-            json += "\"rssi\":" + String(devices[i].rssi) + ",";
-            json += "\"filter\":\"" + filterDesc + "\",";
-            json += "\"alias\":\"" + alias + "\",";
-            json += "\"lastSeen\":" + String(devices[i].lastSeen) + ",";
-            json += "\"timeSince\":" + String(timeSince);
-            json += "}";
-        }
-        
-        json += "],";
-        json += "\"currentTime\":" + String(currentTime);
-        json += "}";
+        std::shared_ptr<DeviceListResponse> list = std::make_shared<DeviceListResponse>();
+        list->currentTime = millis();
+        copyAllDevices(list->rows);
         
-        request->send(200, "application/json", json);
+        request->send(request->beginChunkedResponse("application/json",
+            [list](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                return fillDeviceList(*list, buffer, maxLen);
+            }));
     });
     
     // API endpoint to save device alias
@@ -1994,7 +4442,13 @@ void startConfigMode() {
             String mac = request->getParam("mac", true)->value();
             String alias = request->getParam("alias", true)->value();
             
-            setDeviceAlias(mac, alias);
+            MacAddr parsedMAC;
+            if (MacAddr::parse(mac.c_str(), parsedMAC) != 6) {
+                request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid MAC address\"}");
+                return;
+            }
+            
+            setDeviceAlias(parsedMAC, alias);
             saveDeviceAliases();
             
             if (isSerialConnected()) {
@@ -2169,14 +4623,28 @@ void startConfigMode() {
 // ================================
 // BLE Advertised Device Callback Class
 // ================================
-// ================================
-// BLE Advertised Device Callback Class
-// ================================
+void publishDetection(uint16_t pos, DetectionType type, uint8_t description) {
+    DetectionEvent event;
+    event.seq = detectionSeq++;
+    event.timestamp = millis();
+    event.mac = devices.mac[pos];
+    event.rssi = devices.rssi[pos];
+    event.rssiFiltered = (int8_t)(devices.rssiLevel[pos] / 16);
+    event.trend = rssiTrend(devices.rssiRate[pos]);
+    event.type = type;
+    event.description = description;
+    detectionEvents.push(event);
+    deviceSightings++;
+}
+
 class MyAdvertisedDeviceCallbacks: public NimBLEAdvertisedDeviceCallbacks {
     void onResult(NimBLEAdvertisedDevice* advertisedDevice) {
         if (currentMode != SCANNING_MODE) return;
         
-        String mac = advertisedDevice->getAddress().toString().c_str();
+        NimBLEAddress address = advertisedDevice->getAddress();
+        MacAddr mac = MacAddr::fromLittleEndian(address.getNative());
+        BLEAddressClass addressClass = classifyAddress(address.getType(), mac);
+        advertsByClass[addressClass]++;
         int rssi = advertisedDevice->getRSSI();
         unsigned long currentMillis = millis();
         
@@ -2186,76 +4654,73 @@ class MyAdvertisedDeviceCallbacks: public NimBLEAdvertisedDeviceCallbacks {
             lastRSSIUpdate = currentMillis;
         }
 
-        String matchedDescription;
-        bool matchFound = matchesTargetFilter(mac, matchedDescription);
+        // Interned when the filters were compiled; nothing here allocates
+        uint8_t matchedDescription = NO_DESCRIPTION;
+        bool matchFound;
+        if (addressClass == ADDR_PUBLIC || addressClass == ADDR_RANDOM_STATIC) {
+            matchFound = matchesTargetFilter(mac, matchedDescription);
+        } else {
+            matchFound = matchesRandomAddress(mac, matchedDescription);
+        }
+        if (addressClass == ADDR_RPA && !identityKeys.empty()) {
+            const IdentityKey* owner = resolveRPA(mac);
+            if (owner != nullptr) {
+                // Track the device under its stable identity, not the rotating RPA
+                mac = owner->identity;
+                matchedDescription = owner->descriptionId;
+                matchFound = true;
+            }
+        }
+        if (!matchFound && payloadFilterCount > 0) {
+            matchFound = matchesPayloadFilter(advertisedDevice->getPayload(),
+                                              advertisedDevice->getPayloadLength(),
+                                              matchedDescription);
+        }
         
         if (matchFound) {
-            bool known = false;
-            for (auto& dev : devices) {
-                if (dev.macAddress == mac) {
-                    known = true;
-
-                    if (dev.inCooldown && currentMillis < dev.cooldownUntil) {
-                        return;
-                    }
-
-                    if (dev.inCooldown && currentMillis >= dev.cooldownUntil) {
-                        dev.inCooldown = false;
-                    }
-
-                    unsigned long timeSinceLastSeen = currentMillis - dev.lastSeen;
-
-                    if (timeSinceLastSeen >= 30000) {
-                        detectedMAC = mac;
-                        detectedRSSI = rssi;
-                        matchedFilter = matchedDescription;
-                        matchType = "RE-30s";
-                        newMatchFound = true;
-                        
-                        threeBeeps();
-                        dev.inCooldown = true;
-                        dev.cooldownUntil = currentMillis + 10000;
-                    } else if (timeSinceLastSeen >= 5000) {
-                        detectedMAC = mac;
-                        detectedRSSI = rssi;
-                        matchedFilter = matchedDescription;
-                        matchType = "RE-5s";
-                        newMatchFound = true;
-                        
-                        twoBeeps();
-                        dev.inCooldown = true;
-                        dev.cooldownUntil = currentMillis + 5000;
-                    }
+            if (xSemaphoreTake(deviceTableLock, pdMS_TO_TICKS(DEVICE_LOCK_WAIT_MS)) != pdTRUE) {
+                sightingsDropped++;
+                return;
+            }
+            uint16_t dev = findDevice(mac);
+            if (dev != EMPTY_DEVICE_SLOT) {
+                // Every sighting feeds the filter, even during cooldown
+                updateDeviceRSSI(dev, rssi, currentMillis, false);
+                unsigned long timeSinceLastSeen = currentMillis - devices.lastSeen[dev];
+                
+                if (timeSinceLastSeen < devices.cooldownMs[dev]) {
+                    xSemaphoreGive(deviceTableLock);
+                    return;
+                }
+                devices.cooldownMs[dev] = 0;
 
-                    dev.lastSeen = currentMillis;
-                    break;
+                if (timeSinceLastSeen >= 30000) {
+                    publishDetection(dev, DETECTION_RE_30S, matchedDescription);
+                    
+                    queueAlert(DETECTION_RE_30S, rssi);
+                    devices.cooldownMs[dev] = 10000;
+                } else if (timeSinceLastSeen >= 5000) {
+                    publishDetection(dev, DETECTION_RE_5S, matchedDescription);
+                    
+                    queueAlert(DETECTION_RE_5S, rssi);
+                    devices.cooldownMs[dev] = 5000;
                 }
-            }
 
-            if (!known) {
-                DeviceInfo newDev;
-                newDev.macAddress = mac;
-                newDev.rssi = rssi;
-                newDev.firstSeen = currentMillis;
-                newDev.lastSeen = currentMillis;
-                newDev.inCooldown = false;
-                newDev.cooldownUntil = 0;
-                newDev.matchedFilter = matchedDescription.c_str();
-                newDev.filterDescription = matchedDescription;
-                devices.push_back(newDev);
-
-                detectedMAC = mac;
-                detectedRSSI = rssi;
-                matchedFilter = matchedDescription;
-                matchType = "NEW";
-                newMatchFound = true;
+                devices.lastSeen[dev] = currentMillis;
+            } else {
+                dev = insertDevice(mac);
+                updateDeviceRSSI(dev, rssi, currentMillis, true);
+                devices.firstSeen[dev] = currentMillis;
+                devices.lastSeen[dev] = currentMillis;
+                devices.description[dev] = matchedDescription;
+
+                publishDetection(dev, DETECTION_NEW, devices.description[dev]);
                 
-                threeBeeps();
+                queueAlert(DETECTION_NEW, rssi);
                 
-                auto& dev = devices.back();
-                dev.inCooldown = true;
-                dev.cooldownUntil = currentMillis + 5000;
+                devices.cooldownMs[dev] = 5000;
             }
+            xSemaphoreGive(deviceTableLock);
         }
     }
 };
@@ -2273,8 +4738,12 @@ void startScanningMode() {
         Serial.println("\n=== STARTING SCANNING MODE ===");
         Serial.println("Configured Filters:");
         for (const TargetFilter& filter : targetFilters) {
-            String type = filter.isFullMAC ? "Full MAC" : "OUI";
-            Serial.println("- " + filter.identifier + " (" + type + "): " + filter.description);
+            Serial.println("- " + formatFilter(filter) + " (" + filterTypeName(filter) + "): " + filter.description);
+        }
+        for (int i = 0; i < OUI_DB_VENDOR_COUNT; i++) {
+            if (builtinVendorMask & (1UL << i)) {
+                Serial.println("- Built-in " + describeBuiltinVendor(i));
+            }
         }
         Serial.println("==============================\n");
     }
@@ -2374,6 +4843,7 @@ void setup() {
     esp_log_level_set("*", ESP_LOG_NONE);
     
     initializeBuzzer();
+    startAlertSequencer();
     
     // Test buzzer
     // singleBeep();
@@ -2381,6 +4851,8 @@ void setup() {
     
     initializeNeoPixel();
     
+    initDeviceTable();
+    
     // // Test NeoPixel
     // setNeoPixelColor(255, 0, 255); // Bright pink
     // delay(1000);
@@ -2402,8 +4874,12 @@ void setup() {
         
         // Clear in-memory data
         targetFilters.clear();
-        deviceAliases.clear();
-        devices.clear();
+        rebuildFilterIndex();
+        clearDeviceAliases();
+        clearDeviceTable();
+        if (initJournal()) {
+            clearJournal();
+        }
         
         Serial.println("Factory reset complete - starting with clean state");
     } else {
@@ -2411,7 +4887,11 @@ void setup() {
         loadConfiguration();
         loadWiFiCredentials();
         loadDeviceAliases();
-        loadDetectedDevices();
+        if (initJournal()) {
+            replayJournal();
+        } else {
+            loadDetectedDevices();
+        }
     }
     
     // Check if configuration is locked/burned in
@@ -2483,14 +4963,14 @@ void loop() {
         }
         
         // Check for config timeout 
-        if (targetFilters.size() == 0) {
+        if (!hasActiveFilters()) {
             if (currentMillis - configStartTime > CONFIG_TIMEOUT && lastConfigActivity == configStartTime) {
                 if (isSerialConnected()) {
                     Serial.println("No one connected and no saved filters - staying in config mode");
                     Serial.println("Connect to '" + AP_SSID + "' AP to configure your first filters!");
                 }
             }
-        } else if (targetFilters.size() > 0) {
+        } else {
             if (currentMillis - configStartTime > CONFIG_TIMEOUT && lastConfigActivity == configStartTime) {
                 if (isSerialConnected()) {
                     Serial.println("No one connected within 20s - using saved filters, switching to scanning mode");
@@ -2514,19 +4994,48 @@ void loop() {
     // Scanning mode loop
     if (currentMode == SCANNING_MODE) {
         // Handle match detection messages (JSON output for API)
-        if (newMatchFound) {
-            if (isSerialConnected()) {
-                String alias = getDeviceAlias(detectedMAC);
+        DetectionEvent events[DETECTION_DRAIN_BATCH];
+        size_t eventCount;
+        while ((eventCount = detectionEvents.popBatch(events, DETECTION_DRAIN_BATCH)) > 0) {
+            for (size_t i = 0; i < eventCount; i++) {
+                journalDetection(events[i]);
+            }
+            if (!isSerialConnected()) continue;
+            
+            for (size_t i = 0; i < eventCount; i++) {
+                const DetectionEvent& event = events[i];
+                MacAddr mac(event.mac);
                 
-                Serial.print("{\"mac\":\"");
-                Serial.print(detectedMAC);
+                Serial.print("{\"seq\":");
+                Serial.print(event.seq);
+                Serial.print(",\"mac\":\"");
+                Serial.print(formatMAC(mac));
                 Serial.print("\",\"alias\":\"");
-                Serial.print(alias);
+                Serial.print(getDeviceAlias(mac));
                 Serial.print("\",\"rssi\":");
-                Serial.print(detectedRSSI);
-                Serial.println("}");
+                Serial.print(event.rssi);
+                Serial.print(",\"rssiFiltered\":");
+                Serial.print(event.rssiFiltered);
+                Serial.print(",\"trend\":\"");
+                Serial.print(RSSI_TREND_NAMES[event.trend]);
+                Serial.print("\",\"type\":\"");
+                Serial.print(DETECTION_TYPE_NAMES[event.type]);
+                Serial.println("\"}");
+            }
+        }
+        
+        AlertSummary alerts[ALERT_SUMMARY_RING_SIZE];
+        size_t alertCount = alertSummaries.popBatch(alerts, ALERT_SUMMARY_RING_SIZE);
+        if (isSerialConnected()) {
+            for (size_t i = 0; i < alertCount; i++) {
+                Serial.print("{\"alert\":{\"type\":\"");
+                Serial.print(DETECTION_TYPE_NAMES[alerts[i].type]);
+                Serial.print("\",\"count\":");
+                Serial.print(alerts[i].count);
+                Serial.print(",\"rssi\":");
+                Serial.print(alerts[i].strongestRSSI);
+                Serial.println("}}");
             }
-            newMatchFound = false;
         }
         
         // Restart BLE scan every 3 seconds
@@ -2537,14 +5046,69 @@ void loop() {
             lastScanTime = currentMillis;
         }
 
-        // Auto-save detected devices to NVS every 10 seconds
-        if (currentMillis - lastCleanupTime >= 10000) {
-            saveDetectedDevices();
+        // Flush the journal (or, without LittleFS, save to NVS) every 10 seconds.
+        // While the journal is active the NVS snapshot is no longer refreshed:
+        // it keeps whatever was saved before the upgrade and is only read
+        // back if the journal is empty.
+        if (currentMillis - lastCleanupTime >= JOURNAL_FLUSH_MS) {
+            if (journalReady) {
+                flushJournal();
+            } else {
+                saveDetectedDevices();
+            }
             lastCleanupTime = currentMillis;
         }
 
         if (currentMillis - lastStatusTime >= 30000) {
             lastStatusTime = currentMillis;
+            
+            if (isSerialConnected()) {
+                Serial.print("{\"status\":{\"adverts\":");
+                Serial.print(advertsChecked);
+                Serial.print(",\"fastRejected\":");
+                Serial.print(advertsFastRejected);
+                Serial.print(",\"devices\":");
+                Serial.print(deviceCount);
+                Serial.print(",\"deviceLoad\":");
+                Serial.print(deviceTableLoadFactor(), 3);
+                Serial.print(",\"devicesEvicted\":");
+                Serial.print(devicesEvicted);
+                Serial.print(",\"sightingsDropped\":");
+                Serial.print(sightingsDropped);
+                Serial.print(",\"eventsDropped\":");
+                Serial.print(detectionEvents.dropped());
+                Serial.print(",\"alertsCoalesced\":");
+                Serial.print(alertsCoalesced);
+                Serial.print(",\"alertsStale\":");
+                Serial.print(alertsStale);
+                Serial.print(",\"audioCpuUs\":");
+                Serial.print(audioCpuMicros);
+                Serial.print(",\"audioCallbacks\":");
+                Serial.print(audioCallbacks);
+                Serial.print(",\"frames\":");
+                Serial.print(framesRendered);
+                Serial.print(",\"framesSkipped\":");
+                Serial.print(framesSkipped);
+                Serial.print(",\"framesDeferred\":");
+                Serial.print(framesDeferred);
+                Serial.print(",\"rpaResolved\":");
+                Serial.print(rpaResolved);
+                Serial.print(",\"rpaCacheHits\":");
+                Serial.print(rpaCacheHits);
+                Serial.print(",\"journalRecords\":");
+                Serial.print(journalRecords);
+                Serial.print(",\"journalBytes\":");
+                Serial.print(journalBytesWritten);
+                Serial.print(",\"journalCompactions\":");
+                Serial.print(journalCompactions);
+                for (int i = 0; i < ADDR_CLASS_COUNT; i++) {
+                    Serial.print(",\"");
+                    Serial.print(ADDRESS_CLASS_NAMES[i]);
+                    Serial.print("\":");
+                    Serial.print(advertsByClass[i]);
+                }
+                Serial.println("}}");
+            }
         }
     }
     
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+// ================================
+// Versioned NVS Blobs
+// ================================
+// Packs a table into one byte string so it can be stored with a single
+// putBytes() instead of a key per field. Every blob starts with a fixed
+// header (magic, format version, record count, payload size, generation)
+// and a CRC-32 of the payload, so a torn or foreign value is rejected on
+// load rather than half-applied. Fields are written little-endian one at
+// a time, so the layout does not depend on struct padding.
+// No Arduino dependencies - builds on the host as-is.
+
+struct NvsBlobHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes;   // sizeof(NvsBlobHeader) when written
+    uint32_t count;         // records in the payload
+    uint32_t payloadBytes;
+    uint32_t generation;    // writer's change counter at save time
+    uint32_t crc;           // CRC-32 of the payload
+};
+
+static_assert(sizeof(NvsBlobHeader) == 24, "NvsBlobHeader must stay unpadded");
+
+// CRC-32 (IEEE 802.3, reflected), four bits at a time
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+inline uint32_t crc32(const uint8_t* data, size_t length) {
+    return crc32Update(0, data, length);
+}
+
+class NvsBlobWriter {
+public:
+    NvsBlobWriter(uint32_t magic, uint16_t version) : magic_(magic), version_(version) {
+        bytes_.resize(sizeof(NvsBlobHeader));
+    }
+
+    void reserve(size_t payloadBytes) { bytes_.reserve(sizeof(NvsBlobHeader) + payloadBytes); }
+
+    void put8(uint8_t v) { bytes_.push_back(v); }
+    void put16(uint16_t v) { putLE(v, 2); }
+    void put32(uint32_t v) { putLE(v, 4); }
+    void put48(uint64_t v) { putLE(v, 6); }
+    void putBytes(const void* data, size_t length) {
+        const uint8_t* p = (const uint8_t*)data;
+        bytes_.insert(bytes_.end(), p, p + length);
+    }
+    // 16-bit length, then the characters without a terminator
+    void putString(const char* text, size_t length) {
+        if (length > 0xFFFF) length = 0xFFFF;
+        put16((uint16_t)length);
+        putBytes(text, length);
+    }
+
+    // Bytes written after the header so far, e.g. for string offsets
+    size_t payloadSize() const { return bytes_.size() - sizeof(NvsBlobHeader); }
+
+    // Fills in the header; the result is ready for putBytes()
+    const std::vector<uint8_t>& finish(uint32_t count, uint32_t generation) {
+        NvsBlobHeader header;
+        header.magic = magic_;
+        header.version = version_;
+        header.headerBytes = sizeof(NvsBlobHeader);
+        header.count = count;
+        header.payloadBytes = (uint32_t)payloadSize();
+        header.generation = generation;
+        header.crc = crc32(bytes_.data() + sizeof(NvsBlobHeader), payloadSize());
+        memcpy(bytes_.data(), &header, sizeof(header));
+        return bytes_;
+    }
+
+private:
+    void putLE(uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            bytes_.push_back((uint8_t)(v >> (8 * i)));
+        }
+    }
+
+    uint32_t magic_;
+    uint16_t version_;
+    std::vector<uint8_t> bytes_;
+};
+
+// Reads fields back in the order they were written. Any read past the
+// payload returns zero and latches failed(), so callers can read a whole
+// record and check once.
+class NvsBlobReader {
+public:
+    NvsBlobReader() : payload_(nullptr), length_(0), pos_(0), failed_(true) {
+        memset(&header_, 0, sizeof(header_));
+    }
+
+    // Validates the header and CRC. data must outlive the reader.
+    bool open(const uint8_t* data, size_t length, uint32_t magic, uint16_t version) {
+        failed_ = true;
+        if (data == nullptr || length < sizeof(NvsBlobHeader)) return false;
+        memcpy(&header_, data, sizeof(header_));
+        if (header_.magic != magic || header_.version != version) return false;
+        if (header_.headerBytes != sizeof(NvsBlobHeader)) return false;
+        if (header_.payloadBytes != length - sizeof(NvsBlobHeader)) return false;
+
+        payload_ = data + sizeof(NvsBlobHeader);
+        length_ = header_.payloadBytes;
+        pos_ = 0;
+        if (crc32(payload_, length_) != header_.crc) return false;
+        failed_ = false;
+        return true;
+    }
+
+    uint32_t count() const { return header_.count; }
+    uint32_t generation() const { return header_.generation; }
+    bool failed() const { return failed_; }
+
+    // Random access for offset-based layouts (string tables)
+    const uint8_t* payload() const { return payload_; }
+    size_t payloadSize() const { return length_; }
+    size_t tell() const { return pos_; }
+    void seek(size_t offset) {
+        if (offset > length_) failed_ = true;
+        else pos_ = offset;
+    }
+
+    uint8_t get8() { return (uint8_t)getLE(1); }
+    uint16_t get16() { return (uint16_t)getLE(2); }
+    uint32_t get32() { return (uint32_t)getLE(4); }
+    uint64_t get48() { return getLE(6); }
+    // Returns a view into the blob; length is 0 on failure
+    const char* getString(uint16_t& length) {
+        length = get16();
+        const uint8_t* p = take(length);
+        if (p == nullptr) length = 0;
+        return (const char*)p;
+    }
+
+private:
+    const uint8_t* take(size_t bytes) {
+        if (failed_ || length_ - pos_ < bytes) {
+            failed_ = true;
+            return nullptr;
+        }
+        const uint8_t* p = payload_ + pos_;
+        pos_ += bytes;
+        return p;
+    }
+
+    uint64_t getLE(int bytes) {
+        const uint8_t* p = take(bytes);
+        if (p == nullptr) return 0;
+        uint64_t v = 0;
+        for (int i = bytes - 1; i >= 0; i--) {
+            v = (v << 8) | p[i];
+        }
+        return v;
+    }
+
+    NvsBlobHeader header_;
+    const uint8_t* payload_;
+    size_t length_;
+    size_t pos_;
+    bool failed_;
+};
@@ -0,0 +1,71 @@
+// Generated by tools/gen_oui_db.py from ouis.md - do not edit by hand.
+// Regenerated automatically before each PlatformIO build.
+#pragma once
+
+#include <stdint.h>
+
+#define OUI_DB_VENDOR_COUNT 3
+#define OUI_DB_SIZE 20
+#define OUI_DB_BUCKETS 10
+
+struct OUIVendor {
+    const char* name;
+    const char* category;
+};
+
+struct BuiltinOUI {
+    uint32_t oui;
+    uint8_t vendor;  // index into OUI_DB_VENDORS
+};
+
+constexpr OUIVendor OUI_DB_VENDORS[OUI_DB_VENDOR_COUNT] = {
+    {"RING", "Doorbell/Security Camera"},
+    {"AXON", "Body Camera / Law Enforcement"},
+    {"DJI", "Consumer & Commercial Drones"},
+};
+
+// Per-bucket displacement seeds of the minimal perfect hash
+constexpr uint16_t OUI_DB_SEEDS[OUI_DB_BUCKETS] = {
+    18, 1, 3, 0, 1, 10, 3, 63, 0, 9,
+};
+
+// Entries stored at their perfect hash slot
+constexpr BuiltinOUI OUI_DB[OUI_DB_SIZE] = {
+    {0x58B858, 2},  // DJI
+    {0x343EA4, 0},  // RING
+    {0xCC3BFB, 0},  // RING
+    {0x5C475E, 0},  // RING
+    {0x04A85A, 2},  // DJI
+    {0x54E019, 0},  // RING
+    {0x0C9AE6, 2},  // DJI
+    {0x649A63, 0},  // RING
+    {0x9C7613, 0},  // RING
+    {0x8C5823, 2},  // DJI
+    {0x187F88, 0},  // RING
+    {0xAC9FC3, 0},  // RING
+    {0x60601F, 2},  // DJI
+    {0x0025DF, 1},  // AXON
+    {0x481CB9, 2},  // DJI
+    {0x90486C, 0},  // RING
+    {0xC4DBAD, 0},  // RING
+    {0x34D262, 2},  // DJI
+    {0xE47A2C, 2},  // DJI
+    {0x242BD6, 0},  // RING
+};
+
+inline uint32_t ouiDbHash(uint32_t key, uint32_t seed) {
+    uint32_t x = key ^ (seed * 0x9E3779B9u);
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+// Returns the built-in entry for a 24-bit OUI, or nullptr
+inline const BuiltinOUI* lookupBuiltinOUI(uint32_t oui) {
+    uint32_t bucket = ouiDbHash(oui, 0) % OUI_DB_BUCKETS;
+    const BuiltinOUI& entry = OUI_DB[ouiDbHash(oui, OUI_DB_SEEDS[bucket]) % OUI_DB_SIZE];
+    return entry.oui == oui ? &entry : nullptr;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ================================
+// Lock-Free SPSC Ring
+// ================================
+// Fixed-size queue between exactly one producer task and one consumer
+// task. Each side owns one index and only reads the other's, so no locks
+// are needed; acquire/release ordering publishes the element contents
+// with the index. When full, push() drops the new element and counts it
+// rather than blocking the producer. T should be a small POD.
+// No Arduino dependencies - builds on the host as-is.
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    SpscRing() : head_(0), tail_(0), dropped_(0) {}
+
+    // Producer side
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= N) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[head & (N - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: copies up to maxItems oldest elements into out and
+    // returns how many were taken
+    size_t popBatch(T* out, size_t maxItems) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        uint32_t available = head_.load(std::memory_order_acquire) - tail;
+        size_t count = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = slots_[(tail + i) & (N - 1)];
+        }
+        tail_.store(tail + (uint32_t)count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: drops everything queued
+    void clear() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    T slots_[N];
+    std::atomic<uint32_t> head_;     // next slot to write, producer only
+    std::atomic<uint32_t> tail_;     // next slot to read, consumer only
+    std::atomic<uint32_t> dropped_;
+};
@@ -0,0 +1,179 @@
+// ================================
+// Advertisement Parser Host Test
+// ================================
+// Runs src/ad_parser.h over captured advert payloads and hand-made broken
+// ones: a truncated structure, zero-length padding, a structure longer
+// than the buffer and a lone length byte at the end. Exits non-zero if
+// any check fails, so it can gate a build.
+
+#include <stdio.h>
+#include <string.h>
+#include "ad_parser.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static size_t countFields(const uint8_t* payload, size_t length, bool& malformed) {
+    AdIterator it(payload, length);
+    AdField field;
+    size_t count = 0;
+    while (it.next(field)) {
+        // Every view must stay inside the buffer
+        CHECK(field.value.data >= payload);
+        CHECK(field.value.data + field.value.length <= payload + length);
+        count++;
+    }
+    malformed = it.malformed();
+    return count;
+}
+
+// iBeacon: flags, then Apple manufacturer data (UUID, major 1, minor 2, -59 dBm)
+static const uint8_t IBEACON[] = {
+    0x02, 0x01, 0x06,
+    0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15,
+    0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48, 0xD2, 0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0,
+    0x00, 0x01, 0x00, 0x02, 0xC5,
+};
+
+// Eddystone-URL "https://google.com": flags, 16-bit UUID list, service data
+static const uint8_t EDDYSTONE_URL[] = {
+    0x02, 0x01, 0x06,
+    0x03, 0x03, 0xAA, 0xFE,
+    0x0D, 0x16, 0xAA, 0xFE, 0x10, 0xEB, 0x03, 0x67, 0x6F, 0x6F, 0x67, 0x6C, 0x65, 0x07,
+};
+
+// Scan response: complete local name and TX power
+static const uint8_t NAME_AND_TX_POWER[] = {
+    0x05, 0x09, 0x54, 0x69, 0x6C, 0x65,
+    0x02, 0x0A, 0xF4,
+};
+
+static void testCapturedAdverts() {
+    printf("captured adverts\n");
+    bool malformed;
+
+    CHECK(countFields(IBEACON, sizeof(IBEACON), malformed) == 2);
+    CHECK(!malformed);
+    AdSummary beacon = AdSummary::parse(IBEACON, sizeof(IBEACON));
+    CHECK(!beacon.malformed);
+    CHECK(beacon.hasFlags && beacon.flags == 0x06);
+    CHECK(beacon.hasCompanyId() && beacon.companyId() == 0x004C);
+    CHECK(beacon.manufacturerData.length == 25);
+    CHECK(beacon.manufacturerData.data[2] == 0x02 && beacon.manufacturerData.data[3] == 0x15);
+
+    CHECK(countFields(EDDYSTONE_URL, sizeof(EDDYSTONE_URL), malformed) == 3);
+    CHECK(!malformed);
+    AdSummary eddystone = AdSummary::parse(EDDYSTONE_URL, sizeof(EDDYSTONE_URL));
+    CHECK(eddystone.uuid16List.length == 2 && readLE16(eddystone.uuid16List.data) == 0xFEAA);
+    CHECK(eddystone.serviceData16.length == 12 && readLE16(eddystone.serviceData16.data) == 0xFEAA);
+    CHECK(eddystone.serviceData16.data[2] == 0x10);
+
+    AdSummary response = AdSummary::parse(NAME_AND_TX_POWER, sizeof(NAME_AND_TX_POWER));
+    CHECK(!response.malformed);
+    CHECK(response.nameComplete && response.name.length == 4 && memcmp(response.name.data, "Tile", 4) == 0);
+    CHECK(response.hasTxPower && response.txPower == -12);
+}
+
+static void testTruncated() {
+    printf("truncated structure\n");
+    bool malformed;
+
+    // iBeacon cut off inside the manufacturer data
+    CHECK(countFields(IBEACON, 20, malformed) == 1);
+    CHECK(malformed);
+    AdSummary summary = AdSummary::parse(IBEACON, 20);
+    CHECK(summary.malformed);
+    CHECK(summary.hasFlags);
+    CHECK(summary.manufacturerData.empty());
+
+    // Cut between the length and type bytes
+    CHECK(countFields(IBEACON, 4, malformed) == 1);
+    CHECK(malformed);
+}
+
+static void testZeroLengthTerminator() {
+    printf("zero-length terminator\n");
+    bool malformed;
+
+    // Significant part followed by zero padding, as in a fixed 31-byte buffer
+    static const uint8_t padded[] = {0x02, 0x01, 0x06, 0x00, 0x00, 0x00, 0x00};
+    CHECK(countFields(padded, sizeof(padded), malformed) == 1);
+    CHECK(!malformed);
+
+    // Whatever follows the terminator is not parsed
+    static const uint8_t trailing[] = {0x02, 0x01, 0x06, 0x00, 0x05, 0xFF, 0x4C};
+    CHECK(countFields(trailing, sizeof(trailing), malformed) == 1);
+    CHECK(!malformed);
+
+    // A lone zero at the end is padding too
+    static const uint8_t lastZero[] = {0x02, 0x01, 0x06, 0x00};
+    CHECK(countFields(lastZero, sizeof(lastZero), malformed) == 1);
+    CHECK(!malformed);
+
+    // A structure with a type and no value is valid
+    static const uint8_t typeOnly[] = {0x02, 0x01, 0x06, 0x01, 0x09};
+    CHECK(countFields(typeOnly, sizeof(typeOnly), malformed) == 2);
+    CHECK(!malformed);
+}
+
+static void testOverlong() {
+    printf("overlong structure\n");
+    bool malformed;
+
+    static const uint8_t overlong[] = {0x02, 0x01, 0x06, 0xFF, 0xFF, 0x4C, 0x00};
+    CHECK(countFields(overlong, sizeof(overlong), malformed) == 1);
+    CHECK(malformed);
+    CHECK(AdSummary::parse(overlong, sizeof(overlong)).manufacturerData.empty());
+
+    // One byte too long
+    static const uint8_t offByOne[] = {0x03, 0x03, 0xAA};
+    CHECK(countFields(offByOne, sizeof(offByOne), malformed) == 0);
+    CHECK(malformed);
+}
+
+static void testLoneLengthByte() {
+    printf("lone trailing length byte\n");
+    bool malformed;
+
+    static const uint8_t loneLength[] = {0x02, 0x01, 0x06, 0x05};
+    CHECK(countFields(loneLength, sizeof(loneLength), malformed) == 1);
+    CHECK(malformed);
+    CHECK(AdSummary::parse(loneLength, sizeof(loneLength)).malformed);
+
+    static const uint8_t onlyLength[] = {0x02};
+    CHECK(countFields(onlyLength, sizeof(onlyLength), malformed) == 0);
+    CHECK(malformed);
+}
+
+static void testEmpty() {
+    printf("empty payload\n");
+    bool malformed;
+
+    CHECK(countFields(IBEACON, 0, malformed) == 0);
+    CHECK(!malformed);
+    CHECK(countFields(nullptr, 31, malformed) == 0);
+    CHECK(!malformed);
+}
+
+int main() {
+    testCapturedAdverts();
+    testTruncated();
+    testZeroLengthTerminator();
+    testOverlong();
+    testLoneLengthByte();
+    testEmpty();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,178 @@
+"""
+Generates src/oui_db.h from ouis.md.
+
+Each <details> section of ouis.md becomes a selectable vendor category.
+OUIs are laid out with a minimal perfect hash (hash-and-displace), so the
+firmware resolves an OUI to its vendor with two hashes and one compare,
+straight out of flash.
+
+Runs automatically as a PlatformIO pre-build script, or by hand:
+    python tools/gen_oui_db.py
+"""
+
+import os
+import re
+import sys
+
+MAX_SEED = 0xFFFF
+KEYS_PER_BUCKET = 2
+MAX_VENDORS = 32  # vendor selection is stored as a 32-bit mask
+
+
+def oui_hash(key, seed):
+    # Must match ouiDbHash() in the generated header
+    x = (key ^ ((seed * 0x9E3779B9) & 0xFFFFFFFF)) & 0xFFFFFFFF
+    x ^= x >> 16
+    x = (x * 0x85EBCA6B) & 0xFFFFFFFF
+    x ^= x >> 13
+    x = (x * 0xC2B2AE35) & 0xFFFFFFFF
+    x ^= x >> 16
+    return x
+
+
+def parse_ouis(text):
+    vendors = []
+    entries = []
+    seen = {}
+
+    for section in re.findall(r"<details[^>]*>(.*?)</details>", text, re.S):
+        name = re.search(r"<summary><b>(.*?)</b>", section)
+        if not name:
+            continue
+        category = re.search(r"\*\*Category:\*\*\s*(.*?)\s*$", section, re.M)
+        vendor = len(vendors)
+        vendors.append((name.group(1).strip(), category.group(1).strip() if category else ""))
+
+        for oui in re.findall(r"^- `([0-9A-Fa-f]{2}(?::[0-9A-Fa-f]{2}){2})`", section, re.M):
+            key = int(oui.replace(":", ""), 16)
+            if key in seen:
+                print("gen_oui_db: %s listed under %s and %s, keeping %s" % (
+                    oui, vendors[seen[key]][0], vendors[vendor][0], vendors[seen[key]][0]))
+                continue
+            seen[key] = vendor
+            entries.append((key, vendor))
+
+    if not entries:
+        sys.exit("gen_oui_db: no OUIs found")
+    if len(vendors) > MAX_VENDORS:
+        sys.exit("gen_oui_db: at most %d vendor sections supported" % MAX_VENDORS)
+    return vendors, entries
+
+
+def build_perfect_hash(keys):
+    n = len(keys)
+    bucket_count = max(1, (n + KEYS_PER_BUCKET - 1) // KEYS_PER_BUCKET)
+    buckets = [[] for _ in range(bucket_count)]
+    for key in keys:
+        buckets[oui_hash(key, 0) % bucket_count].append(key)
+
+    seeds = [0] * bucket_count
+    slots = [None] * n
+
+    # Place the largest buckets first while the table is still empty
+    for b in sorted(range(bucket_count), key=lambda i: -len(buckets[i])):
+        if not buckets[b]:
+            continue
+        for seed in range(1, MAX_SEED + 1):
+            placed = [oui_hash(k, seed) % n for k in buckets[b]]
+            if len(set(placed)) == len(placed) and all(slots[p] is None for p in placed):
+                for k, p in zip(buckets[b], placed):
+                    slots[p] = k
+                seeds[b] = seed
+                break
+        else:
+            sys.exit("gen_oui_db: no perfect hash seed found for bucket %d" % b)
+
+    return seeds, slots
+
+
+def c_string(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def render(vendors, entries):
+    vendor_of = dict(entries)
+    seeds, slots = build_perfect_hash([k for k, _ in entries])
+
+    out = []
+    out.append("// Generated by tools/gen_oui_db.py from ouis.md - do not edit by hand.")
+    out.append("// Regenerated automatically before each PlatformIO build.")
+    out.append("#pragma once")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("")
+    out.append("#define OUI_DB_VENDOR_COUNT %d" % len(vendors))
+    out.append("#define OUI_DB_SIZE %d" % len(slots))
+    out.append("#define OUI_DB_BUCKETS %d" % len(seeds))
+    out.append("")
+    out.append("struct OUIVendor {")
+    out.append("    const char* name;")
+    out.append("    const char* category;")
+    out.append("};")
+    out.append("")
+    out.append("struct BuiltinOUI {")
+    out.append("    uint32_t oui;")
+    out.append("    uint8_t vendor;  // index into OUI_DB_VENDORS")
+    out.append("};")
+    out.append("")
+    out.append("constexpr OUIVendor OUI_DB_VENDORS[OUI_DB_VENDOR_COUNT] = {")
+    for name, category in vendors:
+        out.append("    {%s, %s}," % (c_string(name), c_string(category)))
+    out.append("};")
+    out.append("")
+    out.append("// Per-bucket displacement seeds of the minimal perfect hash")
+    out.append("constexpr uint16_t OUI_DB_SEEDS[OUI_DB_BUCKETS] = {")
+    for i in range(0, len(seeds), 12):
+        out.append("    " + " ".join("%d," % s for s in seeds[i:i + 12]))
+    out.append("};")
+    out.append("")
+    out.append("// Entries stored at their perfect hash slot")
+    out.append("constexpr BuiltinOUI OUI_DB[OUI_DB_SIZE] = {")
+    for key in slots:
+        out.append("    {0x%06X, %d},  // %s" % (key, vendor_of[key], vendors[vendor_of[key]][0]))
+    out.append("};")
+    out.append("")
+    out.append("inline uint32_t ouiDbHash(uint32_t key, uint32_t seed) {")
+    out.append("    uint32_t x = key ^ (seed * 0x9E3779B9u);")
+    out.append("    x ^= x >> 16;")
+    out.append("    x *= 0x85EBCA6Bu;")
+    out.append("    x ^= x >> 13;")
+    out.append("    x *= 0xC2B2AE35u;")
+    out.append("    x ^= x >> 16;")
+    out.append("    return x;")
+    out.append("}")
+    out.append("")
+    out.append("// Returns the built-in entry for a 24-bit OUI, or nullptr")
+    out.append("inline const BuiltinOUI* lookupBuiltinOUI(uint32_t oui) {")
+    out.append("    uint32_t bucket = ouiDbHash(oui, 0) % OUI_DB_BUCKETS;")
+    out.append("    const BuiltinOUI& entry = OUI_DB[ouiDbHash(oui, OUI_DB_SEEDS[bucket]) % OUI_DB_SIZE];")
+    out.append("    return entry.oui == oui ? &entry : nullptr;")
+    out.append("}")
+    out.append("")
+    return "\n".join(out)
+
+
+def generate(project_dir):
+    source = os.path.join(project_dir, "ouis.md")
+    target = os.path.join(project_dir, "src", "oui_db.h")
+
+    with open(source, encoding="utf-8") as f:
+        vendors, entries = parse_ouis(f.read())
+    header = render(vendors, entries)
+
+    current = None
+    if os.path.exists(target):
+        with open(target, encoding="utf-8") as f:
+            current = f.read()
+    if header != current:
+        with open(target, "w", encoding="utf-8", newline="\n") as f:
+            f.write(header)
+        print("gen_oui_db: wrote %s (%d OUIs, %d vendors)" % (target, len(entries), len(vendors)))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    generate(env["PROJECT_DIR"])  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
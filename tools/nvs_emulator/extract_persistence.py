@@ -0,0 +1,91 @@
+"""
+Extracts the persistence code from src/main.cpp for the host NVS emulator.
+
+main.cpp is split on its section banners; the sections that hold the
+settings, filters, aliases and device table - with everything they call -
+are copied out unchanged, so the emulator benchmarks exactly the code the
+firmware runs. #line directives keep compiler errors pointing at main.cpp.
+Only the declarations of device-only objects (web server, BLE scanner) are
+left out.
+
+Run by the emulator Makefile, or by hand:
+    python tools/nvs_emulator/extract_persistence.py [main.cpp] [output]
+"""
+
+import os
+import re
+import sys
+
+SECTIONS = [
+    "WiFi AP Configuration",
+    "Operating Modes",
+    "Global Variables",
+    "Serial Configuration",
+    "MAC Address Utility Functions",
+    "Compiled Filter Index",
+    "RPA Resolution",
+    "Configuration Storage Functions",
+    "Device Alias Functions",
+    "Tracked Device Table",
+    "Per-Device RSSI Trend",
+    "Persistent Device Storage Functions",
+]
+
+# Top-level declarations of objects with no host equivalent
+DEVICE_ONLY = re.compile(r"^(AsyncWebServer|NimBLEScan)\b[^;{]*;\s*$")
+
+BANNER = re.compile(r"^// =+\n// (.+)\n// =+\n", re.M)
+
+
+def split_sections(text):
+    sections = {}
+    banners = list(BANNER.finditer(text))
+    for i, banner in enumerate(banners):
+        end = banners[i + 1].start() if i + 1 < len(banners) else len(text)
+        line = text.count("\n", 0, banner.start()) + 1
+        sections[banner.group(1).strip()] = (line, text[banner.start():end])
+    return sections
+
+
+def generate(source, main_path):
+    sections = split_sections(source)
+    missing = [name for name in SECTIONS if name not in sections]
+    if missing:
+        sys.exit("Sections not found in %s: %s" % (main_path, ", ".join(missing)))
+
+    out = [
+        "// Generated by tools/nvs_emulator/extract_persistence.py from src/main.cpp - do not edit by hand.",
+        "",
+    ]
+    for name in SECTIONS:
+        line, body = sections[name]
+        out.append('#line %d "%s"' % (line, main_path))
+        for text in body.rstrip("\n").split("\n"):
+            # Blank the line rather than drop it so #line stays accurate
+            out.append("" if DEVICE_ONLY.match(text) else text)
+        out.append("")
+    return "\n".join(out)
+
+
+def main():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+    main_path = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "src", "main.cpp")
+    out_path = sys.argv[2] if len(sys.argv) > 2 else os.path.join(root, "tools", "nvs_emulator", "build", "persistence.inc")
+
+    with open(main_path, encoding="utf-8") as f:
+        source = f.read()
+    result = generate(source, os.path.relpath(main_path).replace("\\", "/"))
+
+    os.makedirs(os.path.dirname(os.path.abspath(out_path)), exist_ok=True)
+    # Leave an identical file alone so the benchmark is not rebuilt
+    if os.path.exists(out_path):
+        with open(out_path, encoding="utf-8") as f:
+            if f.read() == result:
+                return
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write(result)
+    print("Extracted %d sections from %s -> %s" % (len(SECTIONS), main_path, out_path))
+
+
+if __name__ == "__main__":
+    main()
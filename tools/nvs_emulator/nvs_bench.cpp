@@ -0,0 +1,294 @@
+// ================================
+// NVS Write Cost Benchmark
+// ================================
+// Runs the persistence code of src/main.cpp - extracted unchanged into
+// persistence.inc - against the emulated NVS partition, through a
+// simulated stretch of scanning, and reports what each save function
+// cost in flash: entries and bytes written, garbage collection copies,
+// page erases and estimated latency.
+//
+// The run: boot (load everything), provision synthetic filters and
+// aliases if the image is empty, then for every simulated second feed
+// matched adverts through the same table updates onResult() makes, call
+// saveDetectedDevices() on the loop's flush interval (the path taken
+// when LittleFS is unavailable), and spread web portal sessions
+// (saveConfiguration, saveDeviceAliases, saveWiFiCredentials) over the run.
+//
+//   nvs_bench [--file image] [--pages 5] [--hours 24] [--filters 20]
+//             [--aliases 10] [--devices 300] [--adverts 30] [--save-interval 10]
+//             [--sessions 4] [--seed 1] [--write-us 60] [--erase-us 45000] [--verbose]
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <mbedtls/aes.h>
+#include <esp_heap_caps.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <new>
+#include <random>
+#include "mac_addr.h"
+#include "oui_db.h"
+#include "spsc_ring.h"
+#include "nvs_blob.h"
+
+#include "persistence.inc"
+
+HardwareSerial Serial;
+uint32_t hostMillis = 0;
+
+#define FLASH_ENDURANCE_CYCLES 100000  // per sector, typical SPI NOR
+
+struct BenchOptions {
+    const char* file;
+    size_t pages;
+    double hours;
+    size_t filters;
+    size_t aliases;
+    size_t population;       // distinct matched devices around
+    uint32_t advertsPerMinute;
+    uint32_t saveIntervalS;
+    uint32_t sessions;       // web portal visits over the run
+    uint32_t seed;
+    bool verbose;
+
+    BenchOptions()
+        : file(nullptr), pages(NVS_DEFAULT_PAGES), hours(24), filters(20), aliases(10), population(300),
+          advertsPerMinute(30), saveIntervalS(10), sessions(4), seed(1), verbose(false) {}
+};
+
+// Flash cost of every call to one function
+struct OpStats {
+    const char* name;
+    uint32_t calls;
+    NvsStats total;
+    uint64_t maxUs;
+};
+
+OpStats ops[] = {
+    {"saveDetectedDevices", 0, NvsStats(), 0},
+    {"saveConfiguration", 0, NvsStats(), 0},
+    {"saveDeviceAliases", 0, NvsStats(), 0},
+    {"saveWiFiCredentials", 0, NvsStats(), 0},
+};
+
+#define OP_COUNT (sizeof(ops) / sizeof(ops[0]))
+
+void measure(OpStats& op, void (*save)()) {
+    NvsStats before = nvsFlash().stats;
+    save();
+    NvsStats delta = nvsFlash().stats - before;
+    op.calls++;
+    op.total += delta;
+    if (delta.estimatedUs > op.maxUs) op.maxUs = delta.estimatedUs;
+}
+
+// Same table updates as MyAdvertisedDeviceCallbacks::onResult() for a
+// matched advert; publishDetection() is reduced to its sightings count
+void sightDevice(const MacAddr& mac, int rssi, uint32_t now, uint8_t description) {
+    uint16_t dev = findDevice(mac);
+    if (dev != EMPTY_DEVICE_SLOT) {
+        updateDeviceRSSI(dev, rssi, now, false);
+        uint32_t timeSinceLastSeen = now - devices.lastSeen[dev];
+        if (timeSinceLastSeen < devices.cooldownMs[dev]) return;
+        devices.cooldownMs[dev] = 0;
+
+        if (timeSinceLastSeen >= 30000) {
+            deviceSightings++;
+            devices.cooldownMs[dev] = 10000;
+        } else if (timeSinceLastSeen >= 5000) {
+            deviceSightings++;
+            devices.cooldownMs[dev] = 5000;
+        }
+        devices.lastSeen[dev] = now;
+    } else {
+        dev = insertDevice(mac);
+        updateDeviceRSSI(dev, rssi, now, true);
+        devices.firstSeen[dev] = now;
+        devices.lastSeen[dev] = now;
+        devices.description[dev] = description;
+        deviceSightings++;
+        devices.cooldownMs[dev] = 5000;
+    }
+}
+
+void bootDevice() {
+    loadConfiguration();
+    loadDeviceAliases();
+    loadDetectedDevices();
+    loadWiFiCredentials();
+}
+
+// Fills an empty image the way a user would through the web portal
+void provision(const BenchOptions& options, std::mt19937& rng) {
+    targetFilters.clear();
+    for (size_t i = 0; i < options.filters; i++) {
+        MacAddr oui((uint64_t)(rng() & 0xFCFFFF) << 24);  // unicast, globally administered
+        targetFilters.push_back(makeMACFilter(oui, 24, "Vendor " + String((unsigned)i)));
+    }
+    rebuildFilterIndex();
+    measure(ops[1], saveConfiguration);
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "--file" && hasValue) {
+            options.file = argv[++i];
+        } else if (arg == "--pages" && hasValue) {
+            options.pages = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--hours" && hasValue) {
+            options.hours = strtod(argv[++i], nullptr);
+        } else if (arg == "--filters" && hasValue) {
+            options.filters = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--aliases" && hasValue) {
+            options.aliases = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--devices" && hasValue) {
+            options.population = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--adverts" && hasValue) {
+            options.advertsPerMinute = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--save-interval" && hasValue) {
+            options.saveIntervalS = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--sessions" && hasValue) {
+            options.sessions = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--write-us" && hasValue) {
+            nvsFlash().cost.entryWriteUs = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--erase-us" && hasValue) {
+            nvsFlash().cost.pageEraseUs = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    if (options.saveIntervalS == 0) options.saveIntervalS = 1;
+    return true;
+}
+
+void printReport(double hours) {
+    printf("\n%-20s %7s %7s %7s %9s %9s %9s %7s %6s %10s %8s\n", "function", "calls", "puts", "skipped",
+           "entries", "KB", "relocated", "erases", "failed", "est. ms", "max ms");
+    NvsStats total;
+    for (size_t i = 0; i < OP_COUNT; i++) {
+        const OpStats& op = ops[i];
+        total += op.total;
+        printf("%-20s %7u %7llu %7llu %9llu %9.1f %9llu %7llu %6llu %10.1f %8.1f\n", op.name, op.calls,
+               (unsigned long long)op.total.setCalls, (unsigned long long)op.total.skippedIdentical,
+               (unsigned long long)op.total.entriesWritten, op.total.bytesWritten() / 1024.0,
+               (unsigned long long)op.total.entriesRelocated, (unsigned long long)op.total.pageErases,
+               (unsigned long long)(op.total.failedWrites + op.total.invalidKeys),
+               op.total.estimatedUs / 1000.0, op.maxUs / 1000.0);
+    }
+    printf("%-20s %7s %7llu %7llu %9llu %9.1f %9llu %7llu %6llu %10.1f\n", "total", "",
+           (unsigned long long)total.setCalls, (unsigned long long)total.skippedIdentical,
+           (unsigned long long)total.entriesWritten, total.bytesWritten() / 1024.0,
+           (unsigned long long)total.entriesRelocated, (unsigned long long)total.pageErases,
+           (unsigned long long)(total.failedWrites + total.invalidKeys), total.estimatedUs / 1000.0);
+
+    double days = hours / 24;
+    double erasesPerPageDay = days > 0 ? total.pageErases / (double)nvsFlash().pageCount() / days : 0;
+    printf("\nWrite amplification: %.2f (entries programmed per entry requested)\n",
+           total.entriesWritten > total.entriesRelocated
+               ? total.entriesWritten / (double)(total.entriesWritten - total.entriesRelocated) : 1.0);
+    printf("Flash wear: %llu page erases in %.1f h = %.2f erase cycles per page per day",
+           (unsigned long long)total.pageErases, hours, erasesPerPageDay);
+    if (erasesPerPageDay > 0) {
+        printf(", %.1f years to %d cycles\n", FLASH_ENDURANCE_CYCLES / erasesPerPageDay / 365, FLASH_ENDURANCE_CYCLES);
+    } else {
+        printf("\n");
+    }
+    printf("Partition: %u pages, %u live entries, %u free entries, largest blob %u bytes\n",
+           (unsigned)nvsFlash().pageCount(), (unsigned)nvsFlash().liveEntries(),
+           (unsigned)nvsFlash().freeEntries(), (unsigned)nvsFlash().maxBlobBytes());
+    if (total.failedWrites || total.invalidKeys) {
+        printf("WARNING: %llu writes did not fit, %llu used invalid keys\n",
+               (unsigned long long)total.failedWrites, (unsigned long long)total.invalidKeys);
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) return 2;
+    std::mt19937 rng(options.seed);
+    Serial.setOutput(options.verbose ? stdout : nullptr);
+
+    bool restored = nvsEmulatorAttach(options.file, options.pages);
+    initDeviceTable();
+    bootDevice();
+    if (!restored) {
+        provision(options, rng);
+    }
+
+    // Devices around: MACs under the configured MAC filters
+    std::vector<MacAddr> macFilters;
+    for (const TargetFilter& filter : targetFilters) {
+        if (filter.isMAC()) macFilters.push_back(filter.identifier);
+    }
+    if (macFilters.empty()) {
+        fprintf(stderr, "No MAC filters configured - nothing to detect\n");
+        return 1;
+    }
+    std::vector<MacAddr> population;
+    for (size_t i = 0; i < options.population; i++) {
+        uint64_t prefix = macFilters[rng() % macFilters.size()].value & 0xFFFFFF000000ULL;
+        population.push_back(MacAddr(prefix | (rng() & 0xFFFFFF)));
+    }
+
+    if (!restored) {
+        for (size_t i = 0; i < options.aliases && i < population.size(); i++) {
+            setDeviceAlias(population[i], "Device " + String((unsigned)i));
+        }
+        measure(ops[2], saveDeviceAliases);
+    }
+
+    printf("NVS emulator: %u pages (%u KB), %s image, %.1f h simulated\n", (unsigned)options.pages,
+           (unsigned)(nvsFlash().pageCount() * NVS_PAGE_BYTES / 1024), restored ? "restored" : "fresh", options.hours);
+    printf("%u filters, %u aliases, %u devices around, %u matched adverts/min, save every %u s, %u portal sessions\n",
+           (unsigned)targetFilters.size(), (unsigned)deviceAliases.size(), (unsigned)population.size(),
+           options.advertsPerMinute, options.saveIntervalS, options.sessions);
+
+    uint32_t seconds = (uint32_t)(options.hours * 3600);
+    uint32_t sessionEvery = options.sessions ? seconds / (options.sessions + 1) : 0;
+    uint32_t start = hostMillis;
+    std::uniform_int_distribution<int> rssi(-95, -40);
+    for (uint32_t second = 1; second <= seconds; second++) {
+        // Adverts spread evenly over the minute, devices picked at random
+        uint32_t adverts = (options.advertsPerMinute * second) / 60 - (options.advertsPerMinute * (second - 1)) / 60;
+        for (uint32_t i = 0; i < adverts; i++) {
+            hostMillis = start + second * 1000 + i * 1000 / adverts;
+            const MacAddr& mac = population[rng() % population.size()];
+            uint8_t description;
+            if (matchesTargetFilter(mac, description)) {
+                sightDevice(mac, rssi(rng), hostMillis, description);
+            }
+        }
+        hostMillis = start + second * 1000;
+
+        if (second % options.saveIntervalS == 0) {
+            measure(ops[0], saveDetectedDevices);
+        }
+
+        // A portal visit: one filter renamed, one alias set, AP settings
+        // saved as they were
+        if (sessionEvery && second % sessionEvery == 0 && second / sessionEvery <= options.sessions) {
+            TargetFilter& filter = targetFilters[rng() % targetFilters.size()];
+            filter.description = "Renamed " + String(second);
+            measure(ops[1], saveConfiguration);
+            setDeviceAlias(population[rng() % population.size()], "Seen at " + String(second));
+            measure(ops[2], saveDeviceAliases);
+            measure(ops[3], saveWiFiCredentials);
+        }
+    }
+
+    printReport(options.hours);
+
+    // What the next boot would see
+    bootDevice();
+    printf("Reboot check: %u filters, %u aliases, %u devices restored\n", (unsigned)targetFilters.size(),
+           (unsigned)deviceAliases.size(), (unsigned)deviceCount);
+    return 0;
+}
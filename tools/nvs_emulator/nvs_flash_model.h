@@ -0,0 +1,440 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// ================================
+// NVS Flash Model
+// ================================
+// Host model of the ESP-IDF NVS layout, detailed enough to count what a
+// sequence of Preferences calls costs in flash:
+//  - the partition is split into 4 KB pages of 126 32-byte entries
+//  - integers take one entry; strings a header entry plus their bytes
+//    (NUL included) in 32-byte entries, all on one page; blobs are split
+//    into per-page chunks (header + data entries each) plus an index
+//    entry; each namespace costs one entry the first time it is written
+//  - writes only append to the active page; the replaced value's entries
+//    are marked erased once the new one is in, never reclaimed in place
+//  - one page is always kept free; when another page is needed, the page
+//    with the most erased entries is garbage collected: its live entries
+//    are copied into the free page and it is erased
+//  - writing a value identical to the stored one is skipped, as
+//    nvs_set_*() does
+// Latency is an estimate from per-entry program and per-page erase costs
+// (defaults are typical SPI NOR figures); the counts are exact for the
+// model. No Arduino dependencies.
+
+#define NVS_PAGE_BYTES 4096
+#define NVS_ENTRY_BYTES 32
+#define NVS_PAGE_ENTRIES 126
+#define NVS_KEY_MAX 15               // characters, namespaces and keys
+#define NVS_STRING_MAX 4000          // strings must fit one page
+#define NVS_BLOB_MAX 508000
+#define NVS_DEFAULT_PAGES 5          // huge_app.csv: nvs 0x5000
+
+struct NvsCostModel {
+    uint32_t entryWriteUs;   // program one 32-byte entry and its state bits
+    uint32_t entryEraseUs;   // mark one entry erased
+    uint32_t pageEraseUs;    // erase one 4 KB sector
+    uint32_t callUs;         // lookup and bookkeeping per set/remove
+
+    NvsCostModel() : entryWriteUs(60), entryEraseUs(15), pageEraseUs(45000), callUs(20) {}
+};
+
+struct NvsStats {
+    uint64_t setCalls;          // set/put requests
+    uint64_t skippedIdentical;  // requests that matched the stored value
+    uint64_t removeCalls;
+    uint64_t entriesWritten;    // including garbage collection copies
+    uint64_t entriesRelocated;  // copied by garbage collection
+    uint64_t entriesErased;
+    uint64_t pageErases;
+    uint64_t failedWrites;      // partition full or value too large
+    uint64_t invalidKeys;       // key or namespace over NVS_KEY_MAX
+    uint64_t estimatedUs;
+
+    NvsStats() { reset(); }
+    void reset() { memset(this, 0, sizeof(*this)); }
+    uint64_t bytesWritten() const { return entriesWritten * NVS_ENTRY_BYTES; }
+
+    NvsStats operator-(const NvsStats& o) const {
+        NvsStats d;
+        d.setCalls = setCalls - o.setCalls;
+        d.skippedIdentical = skippedIdentical - o.skippedIdentical;
+        d.removeCalls = removeCalls - o.removeCalls;
+        d.entriesWritten = entriesWritten - o.entriesWritten;
+        d.entriesRelocated = entriesRelocated - o.entriesRelocated;
+        d.entriesErased = entriesErased - o.entriesErased;
+        d.pageErases = pageErases - o.pageErases;
+        d.failedWrites = failedWrites - o.failedWrites;
+        d.invalidKeys = invalidKeys - o.invalidKeys;
+        d.estimatedUs = estimatedUs - o.estimatedUs;
+        return d;
+    }
+    NvsStats& operator+=(const NvsStats& o) {
+        setCalls += o.setCalls;
+        skippedIdentical += o.skippedIdentical;
+        removeCalls += o.removeCalls;
+        entriesWritten += o.entriesWritten;
+        entriesRelocated += o.entriesRelocated;
+        entriesErased += o.entriesErased;
+        pageErases += o.pageErases;
+        failedWrites += o.failedWrites;
+        invalidKeys += o.invalidKeys;
+        estimatedUs += o.estimatedUs;
+        return *this;
+    }
+};
+
+// Item types as Preferences stores them
+enum NvsType : uint8_t {
+    NVS_TYPE_U8, NVS_TYPE_I8, NVS_TYPE_U16, NVS_TYPE_I16,
+    NVS_TYPE_U32, NVS_TYPE_I32, NVS_TYPE_U64, NVS_TYPE_I64,
+    NVS_TYPE_STR, NVS_TYPE_BLOB
+};
+
+class NvsFlashModel {
+public:
+    struct Value {
+        NvsType type;
+        std::vector<uint8_t> data;
+    };
+
+    explicit NvsFlashModel(size_t pages = NVS_DEFAULT_PAGES) { format(pages); }
+
+    // Erases the whole partition; statistics are kept
+    void format(size_t pages) {
+        if (pages < 2) pages = 2;
+        pages_.assign(pages, Page());
+        active_ = 0;
+        values_.clear();
+        records_.clear();
+        recordPool_.clear();
+        freeRecords_.clear();
+        namespaces_.clear();
+    }
+
+    size_t pageCount() const { return pages_.size(); }
+
+    // IDF: 97.6% of the partition less one page of chunk overhead
+    size_t maxBlobBytes() const {
+        size_t limit = pages_.size() * NVS_PAGE_BYTES * 976 / 1000;
+        limit = limit > 4000 ? limit - 4000 : 0;
+        return limit < NVS_BLOB_MAX ? limit : NVS_BLOB_MAX;
+    }
+
+    size_t liveEntries() const {
+        size_t n = 0;
+        for (size_t i = 0; i < pages_.size(); i++) n += pages_[i].live;
+        return n;
+    }
+
+    // Entries a new value could use without garbage collection, as
+    // nvs_get_stats() counts them (the reserved page excluded)
+    size_t freeEntries() const {
+        size_t n = NVS_PAGE_ENTRIES - pages_[active_].used;
+        for (size_t i = 0; i < pages_.size(); i++) {
+            if (i != active_ && pages_[i].used == 0) n += NVS_PAGE_ENTRIES;
+        }
+        return n > NVS_PAGE_ENTRIES ? n - NVS_PAGE_ENTRIES : 0;
+    }
+
+    bool hasNamespace(const std::string& ns) const { return namespaces_.count(ns) != 0; }
+
+    const Value* find(const std::string& ns, const std::string& key) const {
+        std::map<std::string, Value>::const_iterator it = values_.find(fullKey(ns, key));
+        return it == values_.end() ? nullptr : &it->second;
+    }
+
+    // Returns false, keeping the old value, when the key is invalid, the
+    // value is too large or the partition is full
+    bool set(const std::string& ns, const std::string& key, NvsType type, const void* data, size_t length) {
+        stats.setCalls++;
+        stats.estimatedUs += cost.callUs;
+        if (!validName(ns) || !validName(key)) {
+            stats.invalidKeys++;
+            return false;
+        }
+        std::string name = fullKey(ns, key);
+        const uint8_t* bytes = (const uint8_t*)data;
+
+        std::map<std::string, Value>::iterator it = values_.find(name);
+        if (it != values_.end() && it->second.type == type && it->second.data.size() == length &&
+            (length == 0 || memcmp(it->second.data.data(), bytes, length) == 0)) {
+            stats.skippedIdentical++;
+            return true;
+        }
+        if ((type == NVS_TYPE_STR && length + 1 > NVS_STRING_MAX) ||
+            (type == NVS_TYPE_BLOB && length > maxBlobBytes())) {
+            stats.failedWrites++;
+            return false;
+        }
+
+        std::vector<size_t> written;
+        if (namespaces_.count(ns) == 0) {
+            if (!writeRecord(1, written)) {
+                stats.failedWrites++;
+                return false;
+            }
+            namespaces_.insert(ns);
+            written.clear();  // namespace entries are never erased
+        }
+
+        // Write the new value before dropping the old one, as NVS does
+        if (!writeValue(type, length, written)) {
+            for (size_t i = 0; i < written.size(); i++) dropRecord(written[i]);
+            stats.failedWrites++;
+            return false;
+        }
+        if (it != values_.end()) eraseRecords(name);
+        records_[name] = written;
+        Value& value = values_[name];
+        value.type = type;
+        value.data.assign(bytes, bytes + length);
+        return true;
+    }
+
+    bool remove(const std::string& ns, const std::string& key) {
+        stats.removeCalls++;
+        stats.estimatedUs += cost.callUs;
+        std::string name = fullKey(ns, key);
+        if (values_.erase(name) == 0) return false;
+        eraseRecords(name);
+        return true;
+    }
+
+    void eraseNamespace(const std::string& ns) {
+        std::string prefix = fullKey(ns, "");
+        std::vector<std::string> names;
+        for (std::map<std::string, Value>::const_iterator it = values_.begin(); it != values_.end(); ++it) {
+            if (it->first.compare(0, prefix.size(), prefix) == 0) names.push_back(it->first);
+        }
+        for (size_t i = 0; i < names.size(); i++) {
+            stats.removeCalls++;
+            stats.estimatedUs += cost.callUs;
+            values_.erase(names[i]);
+            eraseRecords(names[i]);
+        }
+    }
+
+    // Backing file: a text line with the page count, then per value its
+    // name, type and bytes. Loading rewrites the values into freshly
+    // erased pages, so a reloaded image starts compact; the load itself
+    // is not counted.
+    bool save(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        fprintf(f, "NVSEMU1 %u %u\n", (unsigned)pages_.size(), (unsigned)values_.size());
+        for (std::map<std::string, Value>::const_iterator it = values_.begin(); it != values_.end(); ++it) {
+            uint32_t nameLength = it->first.size();
+            uint32_t dataLength = it->second.data.size();
+            fwrite(&nameLength, 4, 1, f);
+            fwrite(it->first.data(), 1, nameLength, f);
+            fputc(it->second.type, f);
+            fwrite(&dataLength, 4, 1, f);
+            if (dataLength) fwrite(it->second.data.data(), 1, dataLength, f);
+        }
+        return fclose(f) == 0;
+    }
+
+    bool load(const char* path) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        unsigned pages = 0, count = 0;
+        if (fscanf(f, "NVSEMU1 %u %u", &pages, &count) != 2 || fgetc(f) != '\n') {
+            fclose(f);
+            return false;
+        }
+        format(pages);
+        NvsStats saved = stats;
+        bool ok = true;
+        for (unsigned i = 0; i < count && ok; i++) {
+            uint32_t nameLength = 0, dataLength = 0;
+            ok = fread(&nameLength, 4, 1, f) == 1 && nameLength < 256;
+            std::string name(ok ? nameLength : 0, '\0');
+            ok = ok && fread(&name[0], 1, nameLength, f) == nameLength;
+            int type = ok ? fgetc(f) : EOF;
+            ok = ok && type >= NVS_TYPE_U8 && type <= NVS_TYPE_BLOB && fread(&dataLength, 4, 1, f) == 1;
+            std::vector<uint8_t> data(ok ? dataLength : 0);
+            ok = ok && (dataLength == 0 || fread(data.data(), 1, dataLength, f) == dataLength);
+            size_t split = name.find(SEPARATOR);
+            ok = ok && split != std::string::npos &&
+                 set(name.substr(0, split), name.substr(split + 1), (NvsType)type, data.data(), data.size());
+        }
+        fclose(f);
+        stats = saved;
+        return ok;
+    }
+
+    NvsStats stats;
+    NvsCostModel cost;
+
+private:
+    static const char SEPARATOR = '\x1f';
+
+    struct Page {
+        uint16_t used;    // entries written since the page was erased
+        uint16_t live;    // entries still holding current data
+        Page() : used(0), live(0) {}
+    };
+
+    // Entries written together on one page: a primitive, a string, or
+    // one blob chunk / index
+    struct Record {
+        uint32_t page;
+        uint16_t span;
+        bool live;
+    };
+
+    static std::string fullKey(const std::string& ns, const std::string& key) { return ns + SEPARATOR + key; }
+
+    static bool validName(const std::string& name) {
+        return !name.empty() && name.size() <= NVS_KEY_MAX && name.find(SEPARATOR) == std::string::npos;
+    }
+
+    static uint16_t dataEntries(size_t bytes) { return (uint16_t)((bytes + NVS_ENTRY_BYTES - 1) / NVS_ENTRY_BYTES); }
+
+    size_t freePages() const {
+        size_t n = 0;
+        for (size_t i = 0; i < pages_.size(); i++) {
+            if (i != active_ && pages_[i].used == 0) n++;
+        }
+        return n;
+    }
+
+    // Makes the active page able to take span entries: moves to a free
+    // page while more than one is left, otherwise garbage collects
+    bool reserve(uint16_t span) {
+        if (span > NVS_PAGE_ENTRIES) return false;
+        while (NVS_PAGE_ENTRIES - pages_[active_].used < span) {
+            if (freePages() > 1) {
+                for (size_t i = 0; i < pages_.size(); i++) {
+                    if (i != active_ && pages_[i].used == 0) {
+                        active_ = i;
+                        break;
+                    }
+                }
+            } else if (!collectGarbage()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Copies the live entries of the page with the most erased entries
+    // into the reserved free page, erases it, and continues writing on
+    // the copy. Every pass reclaims at least one entry, so callers
+    // looping on it terminate.
+    bool collectGarbage() {
+        size_t victim = pages_.size();
+        int mostErased = 0;
+        for (size_t i = 0; i < pages_.size(); i++) {
+            int erased = pages_[i].used - pages_[i].live;
+            if (erased > mostErased) {
+                victim = i;
+                mostErased = erased;
+            }
+        }
+        if (victim == pages_.size()) return false;
+
+        size_t target = pages_.size();
+        for (size_t i = 0; i < pages_.size(); i++) {
+            if (i != active_ && i != victim && pages_[i].used == 0) {
+                target = i;
+                break;
+            }
+        }
+        if (target == pages_.size()) return false;
+
+        for (size_t i = 0; i < recordPool_.size(); i++) {
+            Record& record = recordPool_[i];
+            if (record.live && record.page == victim) {
+                record.page = target;
+                pages_[target].used += record.span;
+                pages_[target].live += record.span;
+                stats.entriesWritten += record.span;
+                stats.entriesRelocated += record.span;
+                stats.estimatedUs += (uint64_t)record.span * cost.entryWriteUs;
+            }
+        }
+        pages_[victim] = Page();
+        stats.pageErases++;
+        stats.estimatedUs += cost.pageEraseUs;
+        active_ = target;
+        return true;
+    }
+
+    bool writeRecord(uint16_t span, std::vector<size_t>& written) {
+        if (!reserve(span)) return false;
+        Record record;
+        record.page = active_;
+        record.span = span;
+        record.live = true;
+        pages_[active_].used += span;
+        pages_[active_].live += span;
+        stats.entriesWritten += span;
+        stats.estimatedUs += (uint64_t)span * cost.entryWriteUs;
+
+        size_t index;
+        if (freeRecords_.empty()) {
+            index = recordPool_.size();
+            recordPool_.push_back(record);
+        } else {
+            index = freeRecords_.back();
+            freeRecords_.pop_back();
+            recordPool_[index] = record;
+        }
+        written.push_back(index);
+        return true;
+    }
+
+    bool writeValue(NvsType type, size_t length, std::vector<size_t>& written) {
+        if (type < NVS_TYPE_STR) return writeRecord(1, written);
+        if (type == NVS_TYPE_STR) return writeRecord(1 + dataEntries(length + 1), written);
+
+        // Blob: each chunk fills what is left of the active page, then
+        // one index entry ties the chunks together
+        size_t remaining = length;
+        do {
+            if (!reserve(2)) return false;
+            size_t room = (size_t)(NVS_PAGE_ENTRIES - pages_[active_].used - 1) * NVS_ENTRY_BYTES;
+            size_t chunk = remaining < room ? remaining : room;
+            if (!writeRecord(1 + dataEntries(chunk), written)) return false;
+            remaining -= chunk;
+        } while (remaining > 0);
+        return writeRecord(1, written);
+    }
+
+    void dropRecord(size_t index) {
+        Record& record = recordPool_[index];
+        if (!record.live) return;
+        record.live = false;
+        pages_[record.page].live -= record.span;
+        freeRecords_.push_back(index);
+    }
+
+    void eraseRecords(const std::string& name) {
+        std::map<std::string, std::vector<size_t> >::iterator it = records_.find(name);
+        if (it == records_.end()) return;
+        for (size_t i = 0; i < it->second.size(); i++) {
+            stats.entriesErased += recordPool_[it->second[i]].span;
+            stats.estimatedUs += (uint64_t)recordPool_[it->second[i]].span * cost.entryEraseUs;
+            dropRecord(it->second[i]);
+        }
+        records_.erase(it);
+    }
+
+    std::vector<Page> pages_;
+    size_t active_;
+    std::map<std::string, Value> values_;
+    std::map<std::string, std::vector<size_t> > records_;  // live records per name
+    std::vector<Record> recordPool_;
+    std::vector<size_t> freeRecords_;                       // reusable recordPool_ slots
+    std::set<std::string> namespaces_;
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+// ================================
+// Host Arduino Shim
+// ================================
+// Just enough of the Arduino core for the persistence code in main.cpp to
+// compile and run on the host unchanged: String, Serial, the clocks and
+// the FreeRTOS mutex calls. millis() is a simulated clock the driver
+// advances (delay() advances it too); micros() is real host time, for
+// code that times itself. The emulator is single threaded, so mutexes
+// always succeed.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <chrono>
+#include <string>
+
+class String {
+public:
+    String() {}
+    String(const char* text) : s_(text ? text : "") {}
+    String(const char* text, unsigned int length) : s_(text ? text : "", text ? length : 0) {}
+    String(const String& other) : s_(other.s_) {}
+    explicit String(char c) : s_(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : s_(format((unsigned long long)value, base)) {}
+    explicit String(int value, unsigned char base = 10) : s_(formatSigned(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : s_(format(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : s_(formatSigned(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : s_(format(value, base)) {}
+    explicit String(long long value, unsigned char base = 10) : s_(formatSigned(value, base)) {}
+    explicit String(unsigned long long value, unsigned char base = 10) : s_(format(value, base)) {}
+    explicit String(float value, unsigned int decimalPlaces = 2) : s_(formatFloat(value, decimalPlaces)) {}
+    explicit String(double value, unsigned int decimalPlaces = 2) : s_(formatFloat(value, decimalPlaces)) {}
+
+    String& operator=(const String& other) { s_ = other.s_; return *this; }
+    String& operator=(const char* text) { s_ = text ? text : ""; return *this; }
+
+    unsigned int length() const { return s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    const char* c_str() const { return s_.c_str(); }
+    bool reserve(unsigned int size) { s_.reserve(size); return true; }
+
+    char charAt(unsigned int index) const { return index < s_.size() ? s_[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return s_[index]; }
+
+    bool concat(const String& other) { s_ += other.s_; return true; }
+    bool concat(const char* text) { if (text) s_ += text; return true; }
+    bool concat(char c) { s_ += c; return true; }
+    String& operator+=(const String& other) { concat(other); return *this; }
+    String& operator+=(const char* text) { concat(text); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+
+    bool equals(const String& other) const { return s_ == other.s_; }
+    bool equals(const char* text) const { return s_ == (text ? text : ""); }
+    bool equalsIgnoreCase(const String& other) const {
+        if (s_.size() != other.s_.size()) return false;
+        for (size_t i = 0; i < s_.size(); i++) {
+            if (tolower((unsigned char)s_[i]) != tolower((unsigned char)other.s_[i])) return false;
+        }
+        return true;
+    }
+    bool operator==(const String& other) const { return s_ == other.s_; }
+    bool operator==(const char* text) const { return equals(text); }
+    bool operator!=(const String& other) const { return s_ != other.s_; }
+    bool operator!=(const char* text) const { return !equals(text); }
+    bool operator<(const String& other) const { return s_ < other.s_; }
+    int compareTo(const String& other) const { return s_.compare(other.s_); }
+
+    bool startsWith(const String& prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+    bool endsWith(const String& suffix) const {
+        return s_.size() >= suffix.s_.size() && s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(s_.find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return position(s_.find(text.s_, from)); }
+    int lastIndexOf(char c) const { return position(s_.rfind(c)); }
+    int lastIndexOf(const String& text) const { return position(s_.rfind(text.s_)); }
+
+    String substring(unsigned int from) const { return substring(from, s_.size()); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (from >= s_.size()) return String();
+        if (to > s_.size()) to = s_.size();
+        return String(s_.substr(from, to - from));
+    }
+
+    void replace(char find, char with) {
+        for (size_t i = 0; i < s_.size(); i++) {
+            if (s_[i] == find) s_[i] = with;
+        }
+    }
+    void replace(const String& find, const String& with) {
+        if (find.s_.empty()) return;
+        for (size_t pos = s_.find(find.s_); pos != std::string::npos; pos = s_.find(find.s_, pos + with.s_.size())) {
+            s_.replace(pos, find.s_.size(), with.s_);
+        }
+    }
+    void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+    void toLowerCase() { for (size_t i = 0; i < s_.size(); i++) s_[i] = tolower((unsigned char)s_[i]); }
+    void toUpperCase() { for (size_t i = 0; i < s_.size(); i++) s_[i] = toupper((unsigned char)s_[i]); }
+    void trim() {
+        size_t begin = s_.find_first_not_of(" \t\r\n\f\v");
+        if (begin == std::string::npos) { s_.clear(); return; }
+        s_ = s_.substr(begin, s_.find_last_not_of(" \t\r\n\f\v") - begin + 1);
+    }
+    long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s_.c_str(), nullptr); }
+
+    friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, char b) { String r(a); r += b; return r; }
+
+private:
+    explicit String(const std::string& s) : s_(s) {}
+
+    static int position(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+
+    static std::string format(unsigned long long value, unsigned char base) {
+        if (base < 2 || base > 36) base = 10;
+        char buf[66];
+        char* p = buf + sizeof(buf) - 1;
+        *p = 0;
+        do {
+            unsigned digit = value % base;
+            *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+            value /= base;
+        } while (value);
+        return p;
+    }
+    static std::string formatSigned(long long value, unsigned char base) {
+        if (value < 0 && base == 10) return "-" + format(0ULL - (unsigned long long)value, base);
+        return format((unsigned long long)value, base);
+    }
+    static std::string formatFloat(double value, unsigned int decimalPlaces) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+        return buf;
+    }
+
+    std::string s_;
+};
+
+class HardwareSerial {
+public:
+    HardwareSerial() : out_(stdout) {}
+
+    void begin(unsigned long) {}
+    // nullptr disconnects: isSerialConnected() goes false, output is dropped
+    void setOutput(FILE* out) { out_ = out; }
+    operator bool() const { return out_ != nullptr; }
+
+    size_t print(const char* text) {
+        if (!out_) return 0;
+        fputs(text, out_);
+        return strlen(text);
+    }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(char c) { return out_ ? (size_t)(fputc(c, out_) != EOF) : 0; }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(double value, int decimalPlaces = 2) { return print(String(value, decimalPlaces)); }
+    template <typename T> size_t println(const T& value) { return print(value) + print('\n'); }
+    size_t println() { return print('\n'); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (!out_) return 0;
+        va_list args;
+        va_start(args, format);
+        int n = vfprintf(out_, format, args);
+        va_end(args);
+        return n < 0 ? 0 : n;
+    }
+
+private:
+    FILE* out_;
+};
+
+extern HardwareSerial Serial;
+
+// Simulated clock; see hostAdvanceMillis()
+extern uint32_t hostMillis;
+
+inline unsigned long millis() { return hostMillis; }
+inline void delay(uint32_t ms) { hostMillis += ms; }
+inline void hostAdvanceMillis(uint32_t ms) { hostMillis += ms; }
+
+inline unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+typedef void* SemaphoreHandle_t;
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdTRUE 1
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    static int mutex;
+    return &mutex;
+}
+inline int xSemaphoreTake(SemaphoreHandle_t, uint32_t) { return pdTRUE; }
+inline int xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+inline bool psramFound() {
+#ifdef BOARD_HAS_PSRAM
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+// ================================
+// Host Preferences Emulator
+// ================================
+// The arduino-esp32 Preferences API over NvsFlashModel instead of the NVS
+// partition. Every Preferences object shares one emulated partition, as
+// on the device. Attach a backing file with nvsEmulatorAttach() to start
+// from, and keep, the image of a previous run; it is written back when a
+// read-write session ends (each put is committed immediately, as the
+// real library does, so only the file write is deferred).
+// Types follow the ESP32: long is 32 bits, bool is a u8, float/double
+// are blobs.
+
+#include <Arduino.h>
+#include <string>
+#include "../nvs_flash_model.h"
+
+inline NvsFlashModel& nvsFlash() {
+    static NvsFlashModel flash;
+    return flash;
+}
+
+inline std::string& nvsBackingFile() {
+    static std::string path;
+    return path;
+}
+
+// Loads path if it holds an image, otherwise starts from an erased
+// partition of the given size; later sessions save back to path
+inline bool nvsEmulatorAttach(const char* path, size_t pages = NVS_DEFAULT_PAGES) {
+    nvsBackingFile() = path ? path : "";
+    if (path && nvsFlash().load(path)) return true;
+    nvsFlash().format(pages);
+    return false;
+}
+
+inline bool nvsEmulatorSync() {
+    return nvsBackingFile().empty() || nvsFlash().save(nvsBackingFile().c_str());
+}
+
+class Preferences {
+public:
+    Preferences() : started_(false), readOnly_(false) {}
+    ~Preferences() { end(); }
+
+    // Read-only sessions fail on a namespace that was never written, like
+    // nvs_open(NVS_READONLY)
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr) {
+        (void)partitionLabel;
+        if (started_ || name == nullptr) return false;
+        if (readOnly && !nvsFlash().hasNamespace(name)) return false;
+        namespace_ = name;
+        readOnly_ = readOnly;
+        started_ = true;
+        return true;
+    }
+
+    void end() {
+        if (!started_) return;
+        started_ = false;
+        if (!readOnly_) nvsEmulatorSync();
+    }
+
+    bool clear() {
+        if (!writable()) return false;
+        nvsFlash().eraseNamespace(namespace_);
+        return true;
+    }
+
+    bool remove(const char* key) {
+        if (!writable() || key == nullptr) return false;
+        return nvsFlash().remove(namespace_, key);
+    }
+
+    size_t putChar(const char* key, int8_t value) { return put(key, NVS_TYPE_I8, &value, 1); }
+    size_t putUChar(const char* key, uint8_t value) { return put(key, NVS_TYPE_U8, &value, 1); }
+    size_t putShort(const char* key, int16_t value) { return put(key, NVS_TYPE_I16, &value, 2); }
+    size_t putUShort(const char* key, uint16_t value) { return put(key, NVS_TYPE_U16, &value, 2); }
+    size_t putInt(const char* key, int32_t value) { return put(key, NVS_TYPE_I32, &value, 4); }
+    size_t putUInt(const char* key, uint32_t value) { return put(key, NVS_TYPE_U32, &value, 4); }
+    size_t putLong(const char* key, int32_t value) { return put(key, NVS_TYPE_I32, &value, 4); }
+    size_t putULong(const char* key, uint32_t value) { return put(key, NVS_TYPE_U32, &value, 4); }
+    size_t putLong64(const char* key, int64_t value) { return put(key, NVS_TYPE_I64, &value, 8); }
+    size_t putULong64(const char* key, uint64_t value) { return put(key, NVS_TYPE_U64, &value, 8); }
+    size_t putFloat(const char* key, float value) { return put(key, NVS_TYPE_BLOB, &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return put(key, NVS_TYPE_BLOB, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value) {
+        if (value == nullptr) return 0;
+        return put(key, NVS_TYPE_STR, value, strlen(value));
+    }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t length) {
+        if (value == nullptr || length == 0) return 0;
+        return put(key, NVS_TYPE_BLOB, value, length);
+    }
+
+    bool isKey(const char* key) { return lookup(key) != nullptr; }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return get(key, NVS_TYPE_I8, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return get(key, NVS_TYPE_U8, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return get(key, NVS_TYPE_I16, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return get(key, NVS_TYPE_U16, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return get(key, NVS_TYPE_I32, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return get(key, NVS_TYPE_U32, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return get(key, NVS_TYPE_I32, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return get(key, NVS_TYPE_U32, defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return get(key, NVS_TYPE_I64, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return get(key, NVS_TYPE_U64, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return get(key, NVS_TYPE_BLOB, defaultValue); }
+    double getDouble(const char* key, double defaultValue = NAN) { return get(key, NVS_TYPE_BLOB, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) == 1; }
+
+    String getString(const char* key, const String defaultValue = String()) {
+        const NvsFlashModel::Value* value = lookup(key, NVS_TYPE_STR);
+        if (value == nullptr) return defaultValue;
+        return String((const char*)value->data.data(), value->data.size());
+    }
+
+    // Length of a blob, 0 if there is none
+    size_t getBytesLength(const char* key) {
+        const NvsFlashModel::Value* value = lookup(key, NVS_TYPE_BLOB);
+        return value == nullptr ? 0 : value->data.size();
+    }
+
+    // Fails (returns 0) when the blob is larger than maxLength
+    size_t getBytes(const char* key, void* buffer, size_t maxLength) {
+        const NvsFlashModel::Value* value = lookup(key, NVS_TYPE_BLOB);
+        if (value == nullptr || buffer == nullptr || value->data.size() > maxLength) return 0;
+        memcpy(buffer, value->data.data(), value->data.size());
+        return value->data.size();
+    }
+
+    size_t freeEntries() { return nvsFlash().freeEntries(); }
+
+private:
+    bool writable() const { return started_ && !readOnly_; }
+
+    size_t put(const char* key, NvsType type, const void* data, size_t length) {
+        if (!writable() || key == nullptr) return 0;
+        return nvsFlash().set(namespace_, key, type, data, length) ? length : 0;
+    }
+
+    const NvsFlashModel::Value* lookup(const char* key) {
+        if (!started_ || key == nullptr) return nullptr;
+        return nvsFlash().find(namespace_, key);
+    }
+
+    // Like nvs_get_*(), a value stored with another type is not found
+    const NvsFlashModel::Value* lookup(const char* key, NvsType type) {
+        const NvsFlashModel::Value* value = lookup(key);
+        return value != nullptr && value->type == type ? value : nullptr;
+    }
+
+    template <typename T>
+    T get(const char* key, NvsType type, T defaultValue) {
+        const NvsFlashModel::Value* value = lookup(key, type);
+        if (value == nullptr || value->data.size() != sizeof(T)) return defaultValue;
+        T result;
+        memcpy(&result, value->data.data(), sizeof(T));
+        return result;
+    }
+
+    std::string namespace_;
+    bool started_;
+    bool readOnly_;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for the ESP-IDF capability allocator: every heap is malloc
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT   (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+inline void heap_caps_free(void* ptr) { free(ptr); }
@@ -0,0 +1,21 @@
+#pragma once
+
+// Host stand-in for mbedtls AES. The emulator never resolves private
+// addresses; encryption reports an error and outputs zeros.
+
+#include <string.h>
+
+#define MBEDTLS_AES_ENCRYPT 1
+#define MBEDTLS_ERR_AES_BAD_INPUT_DATA -0x0021
+
+typedef struct {
+    int unused;
+} mbedtls_aes_context;
+
+inline void mbedtls_aes_init(mbedtls_aes_context*) {}
+inline void mbedtls_aes_free(mbedtls_aes_context*) {}
+inline int mbedtls_aes_setkey_enc(mbedtls_aes_context*, const unsigned char*, unsigned int) { return 0; }
+inline int mbedtls_aes_crypt_ecb(mbedtls_aes_context*, int, const unsigned char*, unsigned char output[16]) {
+    memset(output, 0, 16);
+    return MBEDTLS_ERR_AES_BAD_INPUT_DATA;
+}